@@ -26,7 +26,9 @@ int32_t main(int32_t argc, char *argv[]) {
   cmd.add_argument("version", 'v', get_version, argument::none, "Prints the version information.");
   // load the argument value into the variable
   cmd.add_argument("file", 'f', args.filename, "The file to be loaded.");
-  cmd.add_argument("ip", 'i', args.ip, "The IP address to connect to.");
+  // match the text of the value, the pattern is compiled once here
+  cmd.add_argument("ip", 'i', args.ip, TinyCmdline::check<std::string>().matches("\\d{1,3}(\\.\\d{1,3}){3}"),
+                   "The IP address to connect to.");
   cmd.add_argument("port", 'p', args.port, "The port to connect to.");
 
   // output:
@@ -51,19 +53,8 @@ int32_t main(int32_t argc, char *argv[]) {
   //   cmd.add_argument("val", 0, args.val, "The value to be set.");
   // set default value
   cmd.add_argument("default_val", 0, args.val, 0, 66, "The value to be set.");
-  // check the range
-  cmd.add_argument(
-      "val", 0,
-      [&args](const char *optarg) {
-        const auto val = std::stoi(optarg);
-        if (val < 0 || val > 100) {
-          fprintf(stderr, "The value should be in the range [0, 100].\n");
-          exit(1);
-        } else {
-          args.val = static_cast<int8_t>(val);
-        }
-      },
-      argument::required, "The value to be set.");  // argument may be optional, so it need to be specified
+  // check the range, a value out of it fails the parse like a value that is not a number
+  cmd.add_argument("val", 0, args.val, TinyCmdline::check<int8_t>().range(0, 100), "The value to be set.");
   cmd.add_argument(
       "user_val", 0,
       [&]() {
@@ -0,0 +1,107 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <cstring>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+
+namespace {
+
+struct pool_config {
+  int32_t size;
+  double timeout;
+};
+
+struct server_config {
+  uint16_t port;
+  int32_t workers;
+  bool verbose;
+  pool_config pool;
+};
+
+const TinyCmdline::field pool_fields[] = {
+    TINY_CMDLINE_FIELD(pool_config, size, "size", 0, "The pool size."),
+    TINY_CMDLINE_FIELD(pool_config, timeout, "timeout", 0, "The idle timeout in seconds."),
+};
+
+struct server {
+  server() {
+    cmd.bind(config, {
+                         TINY_CMDLINE_FIELD(server_config, port, "port", 'p', "The port to listen on."),
+                         TINY_CMDLINE_FIELD(server_config, workers, "workers", 'w', "The number of workers."),
+                         TINY_CMDLINE_FIELD(server_config, verbose, "verbose", 0, "More output."),
+                     });
+    cmd.bind("db.pool", config.pool, pool_fields, sizeof(pool_fields) / sizeof(pool_fields[0]));
+  }
+
+  TinyCmdline::parse_result parse(std::initializer_list<const char *> tokens) {
+    test_argv args(tokens);
+    return cmd.try_parse(args.argc(), args.argv());
+  }
+
+  server_config config{8080, 1, false, {4, 1.5}};
+  TinyCmdline cmd;
+};
+
+void test_fields_are_set_through_their_offsets() {
+  server s;
+  EXPECT(s.parse({"prog", "-p", "9000", "--workers=8", "--verbose", "1", "--db.pool.size", "16",
+                  "--db.pool.timeout=0.25"}));
+  EXPECT(s.config.port == 9000);
+  EXPECT(s.config.workers == 8);
+  EXPECT(s.config.verbose);
+  EXPECT(s.config.pool.size == 16);
+  EXPECT(s.config.pool.timeout == 0.25);
+}
+
+// the fields keep their value when the parse fails
+void test_errors() {
+  server s;
+  auto result = s.parse({"prog", "--port", "70000"});
+  EXPECT(result.error == Error::bad_value && result.argument == "70000" && result.detail == "--port");
+  EXPECT(s.config.port == 8080);
+
+  result = s.parse({"prog", "--db.pool.size=many"});
+  EXPECT(result.error == Error::bad_value && result.detail == "--db.pool.size");
+  EXPECT(s.config.pool.size == 4);
+
+  result = s.parse({"prog", "--db.pool.depth=3"});
+  EXPECT(result.error == Error::unknown_option && result.argument == "--db.pool.depth=3");
+
+  result = s.parse({"prog", "-w"});
+  EXPECT(result.error == Error::missing_value && result.argument == "-w");
+  EXPECT(s.config.workers == 1);
+}
+
+// the same descriptors drive the streaming parsers
+void test_streams() {
+  server s;
+  const char block[] = "-w\0" "3\0" "--db.pool.size\0" "2";
+  EXPECT(s.cmd.try_parse_block(block, sizeof(block) - 1));
+  EXPECT(s.config.workers == 3 && s.config.pool.size == 2);
+
+  TinyCmdline::PushParser<> pusher(s.cmd, " ");
+  const char *line = "--port 81 --db.pool.timeout 2";
+  pusher.feed(line, strlen(line));
+  EXPECT(pusher.finish());
+  EXPECT(s.config.port == 81 && s.config.pool.timeout == 2.0);
+
+  pusher.feed("--port 0x", 9);
+  EXPECT(pusher.finish().error == Error::bad_value);
+  EXPECT(s.config.port == 81);
+}
+
+}  // namespace
+
+int main() {
+  test_fields_are_set_through_their_offsets();
+  test_errors();
+  test_streams();
+  return failed_checks != 0;
+}
@@ -0,0 +1,94 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+// a replay dispatches the same options and leaves argv and optind as the scan did
+void test_hit_replays_the_scan() {
+  TinyCmdline cmd;
+  int32_t port = 0;
+  int32_t verbose = 0;
+  cmd.add_argument("port", 'p', port);
+  cmd.add_argument("verbose", 'v', [&verbose]() { ++verbose; }, argument::none);
+  cmd.set_parse_cache(4);
+
+  test_argv scanned{"prog", "input", "-p", "80", "-v", "--", "-x"};
+  EXPECT(cmd.try_parse_cached(scanned.argc(), scanned.argv()));
+  const int scanned_optind = optind;
+  test_argv replayed{"prog", "input", "-p", "80", "-v", "--", "-x"};
+  port = 0;
+  EXPECT(cmd.try_parse_cached(replayed.argc(), replayed.argv()));
+  EXPECT(port == 80);
+  EXPECT(verbose == 2);
+  EXPECT(optind == scanned_optind);
+  for (int i = 0; i < scanned.argc(); ++i) {
+    EXPECT(std::string(scanned[i]) == replayed[i]);
+  }
+}
+
+// the values handed to the handlers on a hit are in the argv of that parse, not in the cache entry
+void test_values_outlive_eviction() {
+  TinyCmdline cmd;
+  const char *kept = nullptr;
+  std::vector<const char *> includes;
+  cmd.add_argument("name", 'n', [&kept](const char *value) { kept = value; }, argument::required);
+  cmd.add_argument("include", 'I',
+                   [&includes](const char *const *values, size_t count) { includes.assign(values, values + count); },
+                   argument::required);
+  cmd.set_parse_cache(1);
+
+  test_argv miss{"prog", "--name=first", "-Ia", "-I", "b"};
+  EXPECT(cmd.try_parse_cached(miss.argc(), miss.argv()));
+  test_argv hit{"prog", "--name=first", "-Ia", "-I", "b"};
+  EXPECT(cmd.try_parse_cached(hit.argc(), hit.argv()));
+  EXPECT(kept == hit[1] + 7);
+  EXPECT(includes.size() == 2 && includes[0] == hit[2] + 2 && includes[1] == hit[4]);
+
+  // evicts the entry of the hit, its values must still be readable
+  test_argv other{"prog", "--name", "second"};
+  const char *hit_name = kept;
+  const std::vector<const char *> hit_includes = includes;
+  EXPECT(cmd.try_parse_cached(other.argc(), other.argv()));
+  EXPECT(std::string(hit_name) == "first");
+  EXPECT(std::string(hit_includes[0]) == "a" && std::string(hit_includes[1]) == "b");
+  EXPECT(std::string(kept) == "second");
+
+  // misses again after the eviction
+  test_argv again{"prog", "--name=first", "-Ia", "-I", "b"};
+  EXPECT(cmd.try_parse_cached(again.argc(), again.argv()));
+  EXPECT(kept == again[1] + 7);
+}
+
+void test_prefix_names_in_argv() {
+  TinyCmdline cmd;
+  std::string names;
+  cmd.add_prefix_argument(
+      "log", [&names](TinyCmdline::string_ref name, const char *value) { names += name.str() + "=" + value + ";"; },
+      argument::required);
+  cmd.set_parse_cache(2);
+  for (int i = 0; i < 2; ++i) {
+    test_argv args{"prog", "--log.level", "debug", "--log.sink=file"};
+    EXPECT(cmd.try_parse_cached(args.argc(), args.argv()));
+  }
+  EXPECT(names == "log.level=debug;log.sink=file;log.level=debug;log.sink=file;");
+}
+
+}  // namespace
+
+int main() {
+  test_hit_replays_the_scan();
+  test_values_outlive_eviction();
+  test_prefix_names_in_argv();
+  return failed_checks != 0;
+}
@@ -0,0 +1,114 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+struct settings {
+  settings() {
+    cmd.add_argument("val", 0, val, TinyCmdline::check<int8_t>().range(0, 100), "The value to be set.");
+    cmd.add_argument("step", 's', step, TinyCmdline::check<int32_t>().range(10, 100).step(5), "A step.");
+    cmd.add_argument("level", 'l', level, TinyCmdline::check<int32_t>().one_of({1, 5, 9}), "A level.");
+    cmd.add_argument("code", 'c', code, TinyCmdline::check<int32_t>().matches("[1-9]\\d{2}"), "A code.");
+    cmd.add_argument("count", 'n', count, "A count.");
+  }
+
+  TinyCmdline::parse_result parse(std::initializer_list<const char *> tokens) {
+    test_argv args(tokens);
+    return cmd.try_parse(args.argc(), args.argv());
+  }
+
+  TinyCmdline cmd;
+  int8_t val{0};
+  int32_t step{0};
+  int32_t level{0};
+  int32_t code{0};
+  int32_t count{0};
+};
+
+void test_accepted_values() {
+  settings s;
+  EXPECT(s.parse({"prog", "--val", "100", "-s", "15", "-l9", "--code=404"}));
+  EXPECT(s.val == 100 && s.step == 15 && s.level == 9 && s.code == 404);
+}
+
+// a rejected value leaves the target untouched and the result names the option and the rule it broke
+void expect_rejected(std::initializer_list<const char *> tokens, const char *argument, const char *detail) {
+  settings s;
+  const auto result = s.parse(tokens);
+  EXPECT(result.error == Error::bad_value);
+  EXPECT(result.argument == argument);
+  EXPECT(result.detail == detail);
+  if (result.detail != detail) {
+    fprintf(stderr, "detail: %s\n", result.detail.c_str());
+  }
+  EXPECT(s.val == 0 && s.step == 0 && s.level == 0 && s.code == 0 && s.count == 0);
+}
+
+void test_rejected_values() {
+  expect_rejected({"prog", "--val", "200"}, "200", "--val: not a valid value in [0, 100]");
+  expect_rejected({"prog", "--val=-1"}, "--val=-1", "--val: not in [0, 100]");
+  expect_rejected({"prog", "--val", "abc"}, "abc", "--val: not a valid value in [0, 100]");
+  expect_rejected({"prog", "-s", "12"}, "12", "--step: not a multiple of 5 from 10");
+  expect_rejected({"prog", "-s", "5"}, "5", "--step: not in [10, 100]");
+  expect_rejected({"prog", "-l", "4"}, "4", "--level: not one of 1, 5, 9");
+  expect_rejected({"prog", "--code", "099"}, "099", "--code: does not match [1-9]\\d{2}");
+  expect_rejected({"prog", "-n", "x"}, "x", "--count");
+}
+
+// the line parse() prints before the help, read from a child that exits through it
+std::string first_error_line(std::initializer_list<const char *> tokens) {
+  int fds[2];
+  EXPECT(pipe(fds) == 0);
+  const pid_t child = fork();
+  if (child == 0) {
+    dup2(fds[1], STDERR_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[0]);
+    settings s;
+    test_argv args(tokens);
+    s.cmd.parse(args.argc(), args.argv());
+    _exit(0);
+  }
+  close(fds[1]);
+  std::string output;
+  char buffer[256];
+  ssize_t n = 0;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+    output.append(buffer, static_cast<size_t>(n));
+  }
+  close(fds[0]);
+  int status = 0;
+  waitpid(child, &status, 0);
+  EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+  return output.substr(0, output.find('\n'));
+}
+
+void test_parse_prints_the_error() {
+  EXPECT(first_error_line({"prog", "--val", "200"}) == "bad value 200 for --val: not a valid value in [0, 100]");
+  EXPECT(first_error_line({"prog", "-l4"}) == "bad value -l4 for --level: not one of 1, 5, 9");
+  EXPECT(first_error_line({"prog", "--bogus"}) == "unknown option --bogus");
+  EXPECT(first_error_line({"prog", "--count"}) == "missing value for --count");
+}
+
+}  // namespace
+
+int main() {
+  test_accepted_values();
+  test_rejected_values();
+  test_parse_prints_the_error();
+  return failed_checks != 0;
+}
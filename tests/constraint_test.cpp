@@ -0,0 +1,98 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <string>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+struct client {
+  client() {
+    cmd.add_argument("ip", 'i', ip, "The IP address.");
+    cmd.add_argument("port", 'p', port, "The port.");
+    cmd.add_argument("json", 0, [this]() { ++formats; }, argument::none, "JSON output.");
+    cmd.add_argument("yaml", 0, [this]() { ++formats; }, argument::none, "YAML output.");
+    cmd.add_argument("user", 'u', user, "The user.");
+    cmd.add_required({"--user"});
+    cmd.add_exclusive({"--json", "--yaml"});
+    cmd.add_implies("--ip", {"--port"});
+  }
+
+  TinyCmdline::parse_result parse(std::initializer_list<const char *> tokens) {
+    test_argv args(tokens);
+    return cmd.try_parse(args.argc(), args.argv());
+  }
+
+  TinyCmdline cmd;
+  int32_t ip{0};
+  int32_t port{0};
+  int32_t formats{0};
+  int32_t user{0};
+};
+
+void test_satisfied_constraints() {
+  client c;
+  EXPECT(c.parse({"prog", "-u", "1", "--json", "-i", "7", "-p", "80"}));
+  EXPECT(c.parse({"prog", "--user=2", "--yaml"}));
+  EXPECT(c.user == 2 && c.formats == 2);
+}
+
+// every violation is reported at once, one per line
+void test_violations() {
+  client c;
+  auto result = c.parse({"prog", "--json", "--yaml", "-i", "7"});
+  EXPECT(result.error == Error::constraint);
+  EXPECT(result.argument.find("--user") != std::string::npos);
+  EXPECT(result.argument.find("--json") != std::string::npos && result.argument.find("--yaml") != std::string::npos);
+  EXPECT(result.argument.find("--port") != std::string::npos);
+  size_t lines = 1;
+  for (const char c : result.argument) {
+    lines += (c == '\n') ? 1 : 0;
+  }
+  EXPECT(lines == 3);
+
+  result = c.parse({"prog", "-u", "1", "-i", "7"});
+  EXPECT(result.error == Error::constraint && result.argument.find("--port") != std::string::npos);
+
+  // a failed scan reports its own error, the constraints are not checked
+  result = c.parse({"prog", "--bogus"});
+  EXPECT(result.error == Error::unknown_option);
+
+  // a rejected value does not count as given
+  result = c.parse({"prog", "--user=me"});
+  EXPECT(result.error == Error::bad_value);
+}
+
+// the constraints apply to one command at a time, not to the options seen by earlier ones
+void test_each_command_on_its_own() {
+  client c;
+  EXPECT(c.parse({"prog", "-u", "1", "--json"}));
+  EXPECT(c.parse({"prog", "-u", "1", "--yaml"}));
+  EXPECT(c.parse({"prog", "-u", "1"}));
+  EXPECT(c.parse({"prog"}).error == Error::constraint);
+
+  TinyCmdline::PushParser<> pusher(c.cmd, " ");
+  pusher.feed("-u 1 --json", 11);
+  EXPECT(pusher.finish());
+  pusher.feed("--yaml", 6);
+  EXPECT(pusher.finish().error == Error::constraint);
+  pusher.feed("-u 3 --yaml", 11);
+  EXPECT(pusher.finish());
+}
+
+}  // namespace
+
+int main() {
+  test_satisfied_constraints();
+  test_violations();
+  test_each_command_on_its_own();
+  return failed_checks != 0;
+}
@@ -0,0 +1,56 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <stdexcept>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+
+namespace {
+
+template <typename T> bool throws_out_of_range(const char *optarg) {
+  try {
+    TinyCmdline::convert<T>::to(optarg);
+  } catch (const std::out_of_range &) {
+    return true;
+  }
+  return false;
+}
+
+// the throwing to() rejects the values try_to() rejects instead of truncating them into a narrower type
+void test_signed_to_checks_the_range() {
+  EXPECT(TinyCmdline::convert<int8_t>::to("127") == 127);
+  EXPECT(TinyCmdline::convert<int8_t>::to("-128") == -128);
+  EXPECT(throws_out_of_range<int8_t>("128"));
+  EXPECT(throws_out_of_range<int8_t>("300"));
+  EXPECT(throws_out_of_range<int8_t>("-129"));
+  EXPECT(TinyCmdline::convert<int16_t>::to("-32768") == -32768);
+  EXPECT(throws_out_of_range<int16_t>("40000"));
+  EXPECT(TinyCmdline::convert<int32_t>::to("2147483647") == 2147483647);
+  EXPECT(throws_out_of_range<int32_t>("2147483648"));
+  EXPECT(throws_out_of_range<int32_t>("-2147483649"));
+  EXPECT(throws_out_of_range<int64_t>("9223372036854775808"));
+
+  int8_t value = 0;
+  EXPECT(!TinyCmdline::convert<int8_t>::try_to("300", value));
+}
+
+// the unsigned and floating point conversions already checked their range
+void test_other_to_check_the_range() {
+  EXPECT(TinyCmdline::convert<uint8_t>::to("255") == 255);
+  EXPECT(throws_out_of_range<uint8_t>("256"));
+  EXPECT(throws_out_of_range<uint8_t>("-1"));
+  EXPECT(throws_out_of_range<float>("1e300"));
+}
+
+}  // namespace
+
+int main() {
+  test_signed_to_checks_the_range();
+  test_other_to_check_the_range();
+  return failed_checks != 0;
+}
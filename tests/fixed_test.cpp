@@ -0,0 +1,99 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include "test.h"
+
+using tiny_cmdline::FixedCmdline;
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+struct parser {
+  parser() {
+    cmd.add_argument("count", 'c', count, "A count.");
+    cmd.add_argument("verbose", 'v', [this]() { ++verbose; }, argument::none, "More output.");
+    cmd.add_argument("limit", '\0', limit, "A limit.");
+  }
+
+  // getopt_long keeps its state between calls, optind 0 starts over
+  FixedCmdline<4, 256>::parse_result parse(test_argv &args) {
+    optind = 0;
+    return cmd.try_parse(args.argc(), args.argv());
+  }
+
+  FixedCmdline<4, 256> cmd;
+  int32_t count{0};
+  int32_t verbose{0};
+  uint8_t limit{0};
+};
+
+// the errors match the ones of TinyCmdline for the same command line
+void expect_error(std::initializer_list<const char *> tokens, Error error, const char *argument) {
+  parser fixed;
+  test_argv fixed_args(tokens);
+  const auto fixed_result = fixed.parse(fixed_args);
+  EXPECT(fixed_result.error == error);
+  EXPECT(fixed_result.argument != nullptr && std::string(fixed_result.argument) == argument);
+
+  TinyCmdline cmd;
+  int32_t count = 0;
+  uint8_t limit = 0;
+  cmd.add_argument("count", 'c', count);
+  cmd.add_argument("verbose", 'v', []() {}, argument::none);
+  cmd.add_argument("limit", '\0', limit);
+  test_argv args(tokens);
+  const auto result = cmd.try_parse(args.argc(), args.argv());
+  EXPECT(result.error == error);
+}
+
+void test_errors() {
+  expect_error({"prog", "--count"}, Error::missing_value, "--count");
+  expect_error({"prog", "--limit"}, Error::missing_value, "--limit");
+  expect_error({"prog", "-v", "-c"}, Error::missing_value, "-c");
+  expect_error({"prog", "--unknown"}, Error::unknown_option, "--unknown");
+  expect_error({"prog", "-x"}, Error::unknown_option, "-x");
+  expect_error({"prog", "--verbose=1"}, Error::unexpected_value, "--verbose=1");
+  expect_error({"prog", "--count", "ten"}, Error::bad_value, "ten");
+  expect_error({"prog", "--limit=300"}, Error::bad_value, "--limit=300");
+  expect_error({"prog", "-v", "--help"}, Error::help, "--help");
+  expect_error({"prog", "-h"}, Error::help, "-h");
+}
+
+void test_values() {
+  parser fixed;
+  test_argv args{"prog", "input", "-vc", "5", "--limit=7", "-v"};
+  EXPECT(fixed.parse(args));
+  EXPECT(fixed.count == 5);
+  EXPECT(fixed.limit == 7);
+  EXPECT(fixed.verbose == 2);
+  EXPECT(optind == 5 && std::string(args[5]) == "input");
+}
+
+void test_capacity() {
+  parser fixed;
+  int32_t last = 0;
+  EXPECT(fixed.cmd.add_argument("last", 'l', last));
+  EXPECT(fixed.cmd.size() == 4);
+  int32_t extra = 0;
+  EXPECT(!fixed.cmd.add_argument("extra", 'e', extra));
+  EXPECT(!fixed.cmd.add_argument("other", 'c', extra));  // duplicate short name, checked before the capacity
+
+  FixedCmdline<2, 48> small;
+  EXPECT(small.add_argument("first", 'f', extra, "Fits."));
+  EXPECT(!small.add_argument("second", 's', extra, "Does not fit the help."));
+  EXPECT(small.size() == 1);
+}
+
+}  // namespace
+
+int main() {
+  test_errors();
+  test_values();
+  test_capacity();
+  return failed_checks != 0;
+}
@@ -0,0 +1,76 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+
+namespace {
+
+void test_handles_read_the_parsed_values() {
+  TinyCmdline cmd;
+  auto port = cmd.add_argument<int32_t>("port", 'p', "The port.");
+  auto ratio = cmd.add_argument<double>("ratio", 0, "A ratio.");
+  auto level = cmd.add_argument<int32_t>("level", 'l', TinyCmdline::check<int32_t>().range(1, 9), "A level.");
+  test_argv args{"prog", "-p", "8080", "--level=3"};
+  EXPECT(cmd.try_parse(args.argc(), args.argv()));
+  EXPECT(port.was_set() && port.get() == 8080 && cmd[port] == 8080);
+  EXPECT(level.was_set() && level.get() == 3);
+  EXPECT(!ratio.was_set() && ratio.get() == 0.0);
+}
+
+// a value that fails to convert or its check neither changes the value nor marks the option as set
+void test_rejected_values_leave_the_option_unset() {
+  TinyCmdline cmd;
+  auto port = cmd.add_argument<uint16_t>("port", 'p', "The port.");
+  auto level = cmd.add_argument<int32_t>("level", 'l', TinyCmdline::check<int32_t>().range(1, 9), "A level.");
+  test_argv bad_port{"prog", "--port=70000"};
+  EXPECT(cmd.try_parse(bad_port.argc(), bad_port.argv()).error == Error::bad_value);
+  EXPECT(!port.was_set() && port.get() == 0);
+
+  test_argv bad_level{"prog", "-l", "10"};
+  EXPECT(cmd.try_parse(bad_level.argc(), bad_level.argv()).error == Error::bad_value);
+  EXPECT(!level.was_set() && level.get() == 0);
+
+  // a duplicate registration returns an invalid handle
+  EXPECT(!cmd.add_argument<int32_t>("port", 0, "Again.").valid());
+}
+
+// the message about a duplicate names only the forms the option has
+void test_duplicate_message() {
+  TinyCmdline cmd;
+  cmd.add_argument<int32_t>("port", 'p', "The port.");
+  FILE *captured = tmpfile();
+  const int saved = dup(STDERR_FILENO);
+  dup2(fileno(captured), STDERR_FILENO);
+  EXPECT(!cmd.add_argument<int32_t>("port", 0, "Again.").valid());
+  EXPECT(!cmd.add_argument<int32_t>("", 'p', "Again.").valid());
+  EXPECT(!cmd.add_argument<int32_t>("other", 'p', "Again.").valid());
+  dup2(saved, STDERR_FILENO);
+  close(saved);
+  std::string output;
+  rewind(captured);
+  for (int c = fgetc(captured); c != EOF; c = fgetc(captured)) {
+    output += static_cast<char>(c);
+  }
+  fclose(captured);
+  EXPECT(output == "duplicate option --port\nduplicate option -p\nduplicate option -p, --other\n");
+}
+
+}  // namespace
+
+int main() {
+  test_handles_read_the_parsed_values();
+  test_rejected_values_leave_the_option_unset();
+  test_duplicate_message();
+  return failed_checks != 0;
+}
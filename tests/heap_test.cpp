@@ -0,0 +1,93 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+size_t global_news = 0;
+
+}  // namespace
+
+void *operator new(size_t size) {
+  ++global_news;
+  void *p = malloc(size ? size : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace {
+
+struct pool_config {
+  int32_t size;
+  int32_t timeout;
+};
+
+// names and help longer than the small string buffer are copied into the resource, never into a std::string
+void test_registration_stays_in_the_resource() {
+  alignas(std::max_align_t) static unsigned char buffer[1 << 16];
+  TinyCmdline::monotonic_resource resource(buffer, sizeof(buffer));
+  TinyCmdline cmd(&resource);
+  int32_t connections = 0;
+  pool_config pool{0, 0};
+  int32_t handled = 0;
+
+  const size_t before = global_news;
+  auto retries = cmd.add_argument<int32_t>("maximum-connection-retries", 'r', "How many times a connection is retried.");
+  cmd.add_argument("maximum-connection-count", 'c', connections, "How many connections are kept open at most.");
+  cmd.bind("database.connection.pool", pool,
+           {TINY_CMDLINE_FIELD(pool_config, size, "size", 0, "The number of pooled connections."),
+            TINY_CMDLINE_FIELD(pool_config, timeout, "timeout", 0, "The idle timeout of a pooled connection.")});
+  cmd.add_prefix_argument("experimental.features", [&handled](TinyCmdline::string_ref, const char *) { ++handled; },
+                          argument::required, "The experimental features, enabled by name.");
+  cmd.add_preset("connection-profile", "very-conservative", "--maximum-connection-count=1 -r 0");
+  cmd.add_implies("--maximum-connection-count", {"--maximum-connection-retries"});
+  auto level = cmd.add_argument<int32_t>("compression-level", 'l',
+                                         TinyCmdline::check<int32_t>(&resource).one_of({1, 5, 9}),
+                                         "The compression level, 1, 5 or 9.");
+  auto port = cmd.add_argument<int32_t>("listening-port", 0,
+                                        TinyCmdline::check<int32_t>(&resource).matches("[1-9]\\d{3}"),
+                                        "The listening port, four digits.");
+  cmd.add_exclusive({"--database.connection.pool.size", "--connection-profile"});
+  EXPECT(global_news == before);
+
+  test_argv args{"prog", "--connection-profile=very-conservative", "--experimental.features.long-name=1", "-l5",
+                 "--listening-port=8080"};
+  const size_t registered = global_news;
+  EXPECT(cmd.try_parse(args.argc(), args.argv()));
+  EXPECT(global_news == registered);
+  EXPECT(retries.get() == 0);
+  EXPECT(connections == 1);
+  EXPECT(handled == 1);
+  EXPECT(level.get() == 5);
+  EXPECT(port.get() == 8080);
+
+  test_argv rejected{"prog", "-l4"};
+  EXPECT(cmd.try_parse(rejected.argc(), rejected.argv()).error == TinyCmdline::Error::bad_value);
+  test_argv mismatched{"prog", "--listening-port=080"};
+  EXPECT(cmd.try_parse(mismatched.argc(), mismatched.argv()).error == TinyCmdline::Error::bad_value);
+}
+
+}  // namespace
+
+int main() {
+  test_registration_stays_in_the_resource();
+  return failed_checks != 0;
+}
@@ -0,0 +1,81 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+
+namespace {
+
+constexpr char profile[] = "  --port=8080 --workers 16\t--verbose --level=-3 --port 9090 ";
+constexpr const char *known[] = {"port", "workers", "verbose", "level"};
+
+struct defaults {
+  int32_t port;
+  uint8_t workers;
+  int8_t level;
+  int32_t missing;
+  bool verbose;
+  bool quiet;
+};
+
+// constant-initialized, every value is read by the compiler
+constexpr defaults profile_defaults{TinyCmdline::literal_value<int32_t>(profile, "port", 80),
+                                    TinyCmdline::literal_value<uint8_t>(profile, "workers", 1),
+                                    TinyCmdline::literal_value<int8_t>(profile, "level", 0),
+                                    TinyCmdline::literal_value<int32_t>(profile, "missing", 42),
+                                    TinyCmdline::literal_flag(profile, "verbose"),
+                                    TinyCmdline::literal_flag(profile, "quiet")};
+
+static_assert(profile_defaults.port == 9090, "the last value wins");
+static_assert(profile_defaults.workers == 16, "a value in the next token");
+static_assert(profile_defaults.level == -3, "a negative value");
+static_assert(profile_defaults.missing == 42, "the fallback of an absent option");
+static_assert(profile_defaults.verbose && !profile_defaults.quiet, "the flags");
+static_assert(TinyCmdline::literal_known(profile, known), "every option is known");
+static_assert(!TinyCmdline::literal_known("--port=1 --prot=2", known), "a mistyped option is found");
+// a name is not matched by a prefix of another one
+static_assert(TinyCmdline::literal_value<int32_t>("--ports=5", "port", 7) == 7, "whole names only");
+
+// the same functions run at run time, with the same results
+void test_run_time_calls() {
+  const char *args = profile;
+  EXPECT(TinyCmdline::literal_value<int32_t>(args, "port", 80) == 9090);
+  EXPECT(TinyCmdline::literal_value<int32_t>(args, "missing", 42) == 42);
+  EXPECT(TinyCmdline::literal_flag(args, "verbose"));
+}
+
+// a malformed or out-of-range value does not compile in a constant expression, and exits at run time
+bool exits_with_failure(const char *args) {
+  const pid_t child = fork();
+  if (child == 0) {
+    close(STDERR_FILENO);
+    TinyCmdline::literal_value<uint8_t>(args, "workers", 1);
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  return !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+void test_bad_values() {
+  EXPECT(!exits_with_failure("--workers=255"));
+  EXPECT(exits_with_failure("--workers=256"));
+  EXPECT(exits_with_failure("--workers=-1"));
+  EXPECT(exits_with_failure("--workers=ten"));
+  EXPECT(exits_with_failure("--workers"));
+}
+
+}  // namespace
+
+int main() {
+  test_run_time_calls();
+  test_bad_values();
+  return failed_checks != 0;
+}
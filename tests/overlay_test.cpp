@@ -0,0 +1,80 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <cstddef>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+
+namespace {
+
+struct service {
+  service() {
+    timeout = cmd.add_argument<int32_t>("timeout", 't', "The timeout in ms.");
+    retries = cmd.add_argument<int32_t>("retries", 'r', TinyCmdline::check<int32_t>().range(0, 5), "Retries.");
+    ratio = cmd.add_argument<double>("ratio", 0, "A sampling ratio.");
+    cmd.add_argument("workers", 'w', workers, "Workers, not overridable.");
+    test_argv args{"prog", "-t", "100", "-r", "2", "--ratio=0.5"};
+    EXPECT(cmd.try_parse(args.argc(), args.argv()));
+  }
+
+  TinyCmdline cmd;
+  TinyCmdline::Opt<int32_t> timeout;
+  TinyCmdline::Opt<int32_t> retries;
+  TinyCmdline::Opt<double> ratio;
+  int32_t workers{1};
+};
+
+void test_overrides_fall_through_to_the_base() {
+  service s;
+  alignas(std::max_align_t) unsigned char buffer[512];
+  TinyCmdline::monotonic_resource arena(buffer, sizeof(buffer));
+  TinyCmdline::Overlay overlay(s.cmd, &arena);
+  const char *tokens[] = {"--timeout", "50", "-r1", "--timeout=70"};
+  EXPECT(overlay.parse(4, tokens));
+  EXPECT(overlay[s.timeout] == 70 && overlay.overrides(s.timeout));
+  EXPECT(overlay[s.retries] == 1);
+  EXPECT(overlay[s.ratio] == 0.5 && !overlay.overrides(s.ratio));
+  EXPECT(overlay.size() == 2);
+  // the base is never modified
+  EXPECT(s.timeout.get() == 100 && s.retries.get() == 2);
+
+  TinyCmdline::Overlay other(s.cmd, &arena);
+  EXPECT(other[s.timeout] == 100 && other.size() == 0);
+}
+
+void test_errors() {
+  service s;
+  TinyCmdline::Overlay overlay(s.cmd);
+  const char *checked[] = {"-t", "20", "--retries=9", "--ratio=0.1"};
+  auto result = overlay.parse(4, checked);
+  EXPECT(result.error == Error::bad_value && result.argument == "--retries=9");
+  EXPECT(result.detail == "--retries: not in [0, 5]");
+  // the overrides before the error are kept, the ones after it are not parsed
+  EXPECT(overlay[s.timeout] == 20 && overlay[s.retries] == 2 && !overlay.overrides(s.ratio));
+
+  const char *reference[] = {"-w", "4"};
+  result = overlay.parse(2, reference);
+  EXPECT(result.error == Error::not_overridable);
+  EXPECT(s.workers == 1);
+
+  const char *unknown[] = {"--bogus"};
+  EXPECT(overlay.parse(1, unknown).error == Error::unknown_option);
+
+  const char *missing[] = {"--ratio"};
+  EXPECT(overlay.parse(1, missing).error == Error::missing_value);
+  EXPECT(s.ratio.get() == 0.5);
+}
+
+}  // namespace
+
+int main() {
+  test_overrides_fall_through_to_the_base();
+  test_errors();
+  return failed_checks != 0;
+}
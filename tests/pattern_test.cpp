@@ -0,0 +1,118 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+// libstdc++ <regex> trips a false -Wmaybe-uninitialized under the sanitizers
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using pattern = TinyCmdline::pattern;
+
+namespace {
+
+// the bytes of the inputs, each one told apart by some part of the expressions
+const char alphabet[] = {'a', 'b', '0', '_', ' ', '-'};
+
+// every value of up to four bytes of the alphabet, the empty one included
+std::vector<std::string> all_values() {
+  std::vector<std::string> values(1);
+  for (size_t begin = 0, length = 1; length <= 4; ++length) {
+    const size_t end = values.size();
+    for (size_t i = begin; i < end; ++i) {
+      for (const char c : alphabet) {
+        values.push_back(values[i] + c);
+      }
+    }
+    begin = end;
+  }
+  return values;
+}
+
+// deterministic, so a failure reproduces
+struct generator {
+  uint32_t state;
+
+  size_t below(size_t n) {
+    state = state * 1103515245u + 12345u;
+    return (state >> 16) % n;
+  }
+
+  std::string alternation(int depth) {
+    std::string expression = concatenation(depth);
+    if (below(4) == 0) {
+      expression += "|" + concatenation(depth);
+    }
+    return expression;
+  }
+
+  std::string concatenation(int depth) {
+    std::string expression;
+    for (size_t pieces = 1 + below(3); pieces > 0; --pieces) {
+      expression += atom(depth);
+      static const char *const repeats[] = {"", "", "", "*", "+", "?", "{2}", "{1,2}", "{0,}", "{1,3}"};
+      expression += repeats[below(sizeof(repeats) / sizeof(repeats[0]))];
+    }
+    return expression;
+  }
+
+  std::string atom(int depth) {
+    static const char *const atoms[] = {"a",   "b",    "0",     "_",     "\\-",   " ",   ".",   "[ab]", "[^a]",
+                                        "[0-9_]", "[a-]", "\\d", "\\w",  "\\s",   "\\D", "\\W", "\\S"};
+    const size_t count = sizeof(atoms) / sizeof(atoms[0]);
+    const size_t pick = below(depth > 0 ? count + 3 : count);
+    return (pick < count) ? atoms[pick] : "(" + alternation(depth - 1) + ")";
+  }
+};
+
+// the DFA accepts exactly the values std::regex_match accepts
+void expect_same_as_regex(const std::string &expression, const std::vector<std::string> &values) {
+  const pattern compiled(expression.c_str());
+  EXPECT(compiled.valid());
+  const std::regex reference(expression);
+  size_t differences = 0;
+  for (const auto &value : values) {
+    if (compiled.matches(value.c_str()) != std::regex_match(value, reference) && differences++ == 0) {
+      fprintf(stderr, "%s differs from std::regex on \"%s\"\n", expression.c_str(), value.c_str());
+    }
+  }
+  EXPECT(differences == 0);
+}
+
+void test_written_expressions_match_like_regex() {
+  const std::vector<std::string> values = all_values();
+  const char *const expressions[] = {
+      "",           "a",          "ab",           "a|b",        "a*",         "a+",          "a?",
+      "(ab)*",      "(a|b)+",     "a{2}",         "a{2,}",      "a{1,3}",     "(a|ab){0,2}", "[a-b0]+",
+      "[^ab]*",     "[_a-]+",     "\\d+",         "\\w*",       "\\s?a",      "\\D\\W\\S",   ".*",
+      "a.b",        "(a*)*",      "(a|b|0)*_",    "((a)|(b))+", "\\-?\\d+",   "[a-z_][\\w-]*", "(a?){3}",
+      "a(b|0)?_*",  "(ab|a)(b0|0)?", "[0-9]{1,2}-?[0-9]{0,2}",
+  };
+  for (const char *expression : expressions) {
+    expect_same_as_regex(expression, values);
+  }
+}
+
+void test_generated_expressions_match_like_regex() {
+  const std::vector<std::string> values = all_values();
+  generator generate{2024};
+  for (int i = 0; i < 200; ++i) {
+    expect_same_as_regex(generate.alternation(2), values);
+  }
+}
+
+}  // namespace
+
+int main() {
+  test_written_expressions_match_like_regex();
+  test_generated_expressions_match_like_regex();
+  return failed_checks != 0;
+}
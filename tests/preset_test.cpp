@@ -0,0 +1,96 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+struct tuned {
+  tuned() {
+    cmd.add_argument("batch", 'b', batch, "The batch size.");
+    cmd.add_argument("threads", 't', threads, "The number of threads.");
+    cmd.add_argument("spin", 0, [this]() { spin = true; }, argument::none, "Spin instead of sleeping.");
+    cmd.add_argument("tag", 0, [this](const char *const *values, size_t count) {
+      tags.assign(values, values + count);
+    }, argument::required, "Adds a tag.");
+    cmd.add_prefix_argument("log", [this](TinyCmdline::string_ref name, const char *value) {
+      logs.push_back(name.str() + "=" + value);
+    }, argument::required, "Log settings.");
+    cmd.add_preset("profile", "low-latency", "--batch=1 --threads 8 --spin --tag fast --log.level=warn");
+    cmd.add_preset("profile", "throughput", "-b 64 -t2 --tag bulk --tag big");
+  }
+
+  TinyCmdline::parse_result parse(std::initializer_list<const char *> tokens) {
+    test_argv args(tokens);
+    return cmd.try_parse(args.argc(), args.argv());
+  }
+
+  TinyCmdline cmd;
+  int32_t batch{0};
+  int32_t threads{0};
+  bool spin{false};
+  std::vector<std::string> tags;
+  std::vector<std::string> logs;
+};
+
+void test_presets_apply_their_arguments() {
+  tuned t;
+  EXPECT(t.parse({"prog", "--profile=low-latency"}));
+  EXPECT(t.batch == 1 && t.threads == 8 && t.spin);
+  EXPECT((t.tags == std::vector<std::string>{"fast"}));
+  EXPECT((t.logs == std::vector<std::string>{"log.level=warn"}));
+
+  // the arguments after a preset override it, bulk values collect from both
+  tuned u;
+  EXPECT(u.parse({"prog", "--profile", "throughput", "-t", "3", "--tag=mine"}));
+  EXPECT(u.batch == 64 && u.threads == 3 && !u.spin);
+  EXPECT((u.tags == std::vector<std::string>{"bulk", "big", "mine"}));
+}
+
+// a preset applies the same way from a stream and for every command of a PushParser
+void test_presets_in_streams() {
+  tuned t;
+  TinyCmdline::PushParser<> pusher(t.cmd, " ");
+  for (int command = 0; command < 2; ++command) {
+    t.tags.clear();
+    pusher.feed("--profile throughput --tag x", 28);
+    EXPECT(pusher.finish());
+    EXPECT((t.tags == std::vector<std::string>{"bulk", "big", "x"}));
+  }
+  EXPECT(t.batch == 64);
+}
+
+void test_errors() {
+  tuned t;
+  auto result = t.parse({"prog", "--profile=fastest"});
+  EXPECT(result.error == Error::bad_value && result.argument == "--profile=fastest");
+  EXPECT(t.batch == 0);
+
+  result = t.parse({"prog", "--profile"});
+  EXPECT(result.error == Error::missing_value);
+
+  // a preset with an unknown option is rejected when it is added, its value selects nothing
+  t.cmd.add_preset("profile", "broken", "--batch=2 --unknown");
+  result = t.parse({"prog", "--profile=broken"});
+  EXPECT(result.error == Error::bad_value);
+  EXPECT(t.batch == 0);
+}
+
+}  // namespace
+
+int main() {
+  test_presets_apply_their_arguments();
+  test_presets_in_streams();
+  test_errors();
+  return failed_checks != 0;
+}
@@ -0,0 +1,213 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+void feed(TinyCmdline::PushParser<> &pusher, const char *data) { pusher.feed(data, strlen(data)); }
+
+struct console {
+  console() {
+    cmd.add_argument("count", 'c', count, "A count.");
+    cmd.add_argument("name", 'n', [this](const char *value) { name = value; }, argument::required, "A name.");
+    cmd.add_argument("verbose", 'v', [this]() { ++verbose; }, argument::none, "More output.");
+    cmd.set_positional_handler([this](const char *value) { positional.push_back(value); });
+  }
+
+  TinyCmdline cmd;
+  int32_t count{0};
+  std::string name;
+  int32_t verbose{0};
+  std::vector<std::string> positional;
+};
+
+// the tokens and values may be split anywhere between the calls, the options fire once complete
+void test_command_split_across_feeds() {
+  console c;
+  TinyCmdline::PushParser<> pusher(c.cmd, " \t\n");
+  feed(pusher, "-v --cou");
+  EXPECT(c.verbose == 1);
+  feed(pusher, "nt 12");
+  EXPECT(c.count == 0);
+  feed(pusher, "34 --na");
+  EXPECT(c.count == 1234);
+  feed(pusher, "me=ab");
+  feed(pusher, "c\tfi");
+  EXPECT(c.name == "abc");
+  feed(pusher, "le");
+  EXPECT(c.positional.empty());
+  EXPECT(pusher.finish());
+  EXPECT((c.positional == std::vector<std::string>{"file"}));
+
+  // byte by byte, with collapsed delimiters
+  const char *line = "  -c\t\t7 -n  x -- -v\n";
+  for (const char *p = line; *p != '\0'; ++p) {
+    pusher.feed(p, 1);
+  }
+  EXPECT(pusher.finish());
+  EXPECT(c.count == 7);
+  EXPECT(c.name == "x");
+  EXPECT(c.verbose == 1);
+  EXPECT((c.positional == std::vector<std::string>{"file", "-v"}));
+}
+
+// whole tokens, and NUL-delimited bytes without extra delimiters
+void test_tokens() {
+  console c;
+  TinyCmdline::PushParser<> pusher(c.cmd);
+  pusher.feed("--name");
+  pusher.feed("with space");
+  pusher.feed("-vc3");
+  EXPECT(pusher.finish());
+  EXPECT(c.name == "with space");
+  EXPECT(c.count == 3 && c.verbose == 1);
+
+  const char block[] = "--count\0" "42\0" "-n\0" "a b";
+  pusher.feed(block, sizeof(block) - 1);
+  EXPECT(c.count == 42);
+  EXPECT(pusher.finish());
+  EXPECT(c.name == "a b");
+}
+
+// every finish() ends one command, an error only fails its own command
+void test_finish_resets_between_commands() {
+  console c;
+  TinyCmdline::PushParser<> pusher(c.cmd, " ");
+  EXPECT(pusher.finish());
+
+  feed(pusher, "-v --count");
+  auto result = pusher.finish();
+  EXPECT(result.error == Error::missing_value && result.argument == "--count");
+
+  // the pending option of the failed command does not take this value
+  feed(pusher, "5");
+  EXPECT(pusher.finish());
+  EXPECT(c.count == 0);
+  EXPECT((c.positional == std::vector<std::string>{"5"}));
+
+  feed(pusher, "--bogus -c 9");
+  result = pusher.finish();
+  EXPECT(result.error == Error::unknown_option && result.argument == "--bogus");
+  EXPECT(c.count == 0);
+
+  feed(pusher, "--count=ten");
+  result = pusher.finish();
+  EXPECT(result.error == Error::bad_value);
+
+  feed(pusher, "-c 9");
+  EXPECT(pusher.finish());
+  EXPECT(c.count == 9);
+  EXPECT(c.verbose == 1);
+}
+
+void test_too_long() {
+  console c;
+  TinyCmdline::PushParser<8> pusher(c.cmd, " ");
+  pusher.feed("-n 1234567 -v", 13);
+  EXPECT(pusher.finish());
+  EXPECT(c.name == "1234567" && c.verbose == 1);
+
+  pusher.feed("-n 12345678", 11);
+  const auto result = pusher.finish();
+  EXPECT(result.error == Error::too_long);
+  EXPECT(c.name == "1234567");
+}
+
+struct stream_capture {
+  std::string data;
+  size_t chunks{0};
+  size_t ends{0};
+
+  void operator()(const char *chunk, size_t size) {
+    if (chunk == nullptr) {
+      ++ends;
+      return;
+    }
+    data.append(chunk, size);
+    ++chunks;
+  }
+};
+
+// a plain value is one chunk, @path streams the file in chunks, then (nullptr, 0) ends the value
+void test_stream_handler() {
+  TinyCmdline cmd;
+  stream_capture payload;
+  cmd.add_argument("payload", 'p', [&payload](const char *chunk, size_t size) { payload(chunk, size); },
+                   argument::required, "The payload, - for stdin or @file.");
+  TinyCmdline::PushParser<> pusher(cmd, " ");
+  feed(pusher, "--payload inline");
+  EXPECT(pusher.finish());
+  EXPECT(payload.data == "inline" && payload.chunks == 1 && payload.ends == 1);
+
+  char path[] = "/tmp/tiny_cmdline_push_XXXXXX";
+  const int fd = mkstemp(path);
+  EXPECT(fd >= 0);
+  std::string content;
+  for (size_t i = 0; i < 3 * TinyCmdline::stream_chunk_size; ++i) {
+    content += static_cast<char>('a' + i % 26);
+  }
+  EXPECT(write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+  close(fd);
+
+  payload = stream_capture();
+  pusher.feed("-p");
+  pusher.feed(("@" + std::string(path)).c_str());
+  EXPECT(pusher.finish());
+  EXPECT(payload.data == content);
+  EXPECT(payload.chunks >= 3 && payload.ends == 1);
+
+  unlink(path);
+  payload = stream_capture();
+  pusher.feed("-p");
+  pusher.feed(("@" + std::string(path)).c_str());
+  const auto result = pusher.finish();
+  EXPECT(result.error == Error::io);
+  EXPECT(payload.ends == 0);
+}
+
+// a bulk value points into the token buffer while it is fed, each command keeps its own copy
+void test_bulk_values_across_commands() {
+  TinyCmdline cmd;
+  std::vector<std::string> includes;
+  std::string x;
+  cmd.add_argument("inc", 0, [&includes](const char *const *values, size_t count) {
+    includes.assign(values, values + count);
+  }, argument::required);
+  cmd.add_argument("x", 0, [&x](const char *value) { x = value; }, argument::required);
+  TinyCmdline::PushParser<> pusher(cmd, " ");
+  for (int command = 0; command < 2; ++command) {
+    feed(pusher, "--inc aaa --inc bbb --x zzzzzz");
+    EXPECT(pusher.finish());
+    EXPECT((includes == std::vector<std::string>{"aaa", "bbb"}));
+    EXPECT(x == "zzzzzz");
+    includes.clear();
+  }
+}
+
+}  // namespace
+
+int main() {
+  test_command_split_across_feeds();
+  test_tokens();
+  test_finish_resets_between_commands();
+  test_too_long();
+  test_stream_handler();
+  test_bulk_values_across_commands();
+  return failed_checks != 0;
+}
@@ -0,0 +1,150 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <getopt.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+// what a parse did: the options in dispatch order with their values, then argv and optind
+struct outcome {
+  bool ok;
+  std::vector<std::pair<int, std::string>> options;
+  std::vector<std::string> argv;
+  int optind;
+};
+
+void record(outcome &out, int option, const char *value) {
+  out.options.emplace_back(option, (value != nullptr) ? value : "<none>");
+}
+
+// a short optional option takes an attached value or the next argument, like "c:", its long form only a value after '='
+outcome run_getopt(test_argv &args) {
+  static const struct option long_options[] = {
+      {"alpha", no_argument, nullptr, 'a'},   {"beta", required_argument, nullptr, 'b'},
+      {"gamma", optional_argument, nullptr, 'c'}, {"delta", no_argument, nullptr, 256},
+      {"delete", required_argument, nullptr, 257}, {nullptr, 0, nullptr, 0},
+  };
+  outcome out{true, {}, {}, 0};
+  optind = 0;
+  opterr = 0;
+  int c = 0;
+  while ((c = getopt_long(args.argc(), args.argv(), "ab:c:", long_options, nullptr)) != -1) {
+    if (c == '?' || c == ':') {
+      out.ok = false;
+      break;
+    }
+    record(out, c, optarg);
+  }
+  out.optind = optind;
+  return out;
+}
+
+outcome run_scanner(test_argv &args) {
+  outcome out{true, {}, {}, 0};
+  TinyCmdline cmd;
+  cmd.add_argument("alpha", 'a', [&out]() { record(out, 'a', nullptr); }, argument::none);
+  cmd.add_argument("beta", 'b', [&out](const char *value) { record(out, 'b', value); }, argument::required);
+  cmd.add_argument("gamma", 'c', [&out](const char *value) { record(out, 'c', value); }, argument::optional);
+  cmd.add_argument("delta", '\0', [&out]() { record(out, 256, nullptr); }, argument::none);
+  cmd.add_argument("delete", '\0', [&out](const char *value) { record(out, 257, value); }, argument::required);
+  out.ok = !!cmd.try_parse(args.argc(), args.argv());
+  out.optind = optind;
+  return out;
+}
+
+void capture_argv(outcome &out, const test_argv &args) {
+  for (int i = 0; i < args.argc(); ++i) {
+    out.argv.emplace_back(args[static_cast<size_t>(i)]);
+  }
+}
+
+// every command line of up to three tokens parses like getopt_long: the same options and values in the same order,
+// the same permutation of argv and the same optind, and an error where getopt_long reports one
+void test_matches_getopt_long() {
+  const std::vector<std::string> tokens = {
+      "-a",      "-b",     "-c",      "-ab",     "-ba",    "-bx",     "-cx",  "-ac",   "-ca",
+      "--alpha", "--al",   "--alpha=1", "--beta", "--beta=v", "--be",  "--gamma", "--gamma=v", "--ga",
+      "--del",   "--delt", "--dele=x", "--",     "-",      "pos",     "-z",   "--zeta",
+  };
+  size_t compared = 0;
+  std::vector<size_t> picks;
+  for (size_t length = 1; length <= 3; ++length) {
+    picks.assign(length, 0);
+    while (true) {
+      std::vector<std::string> line = {"prog"};
+      for (const size_t pick : picks) {
+        line.push_back(tokens[pick]);
+      }
+      test_argv for_getopt(line);
+      test_argv for_scanner(line);
+      outcome expected = run_getopt(for_getopt);
+      outcome scanned = run_scanner(for_scanner);
+      ++compared;
+      bool same = expected.ok == scanned.ok && expected.options == scanned.options;
+      if (expected.ok && same) {
+        capture_argv(expected, for_getopt);
+        capture_argv(scanned, for_scanner);
+        same = expected.argv == scanned.argv && expected.optind == scanned.optind;
+      }
+      if (!same) {
+        std::string shown;
+        for (const auto &token : line) {
+          shown += token + " ";
+        }
+        fprintf(stderr, "differs from getopt_long: %s\n", shown.c_str());
+      }
+      EXPECT(same);
+      // the next line, the last token varies first
+      size_t i = length;
+      while (i > 0 && ++picks[i - 1] == tokens.size()) {
+        picks[--i] = 0;
+      }
+      if (i == 0) {
+        break;
+      }
+    }
+  }
+  EXPECT(compared == 26 + 26 * 26 + 26 * 26 * 26);
+}
+
+// -h asks for help on its own, an 'h' bundled with other options is unknown unless it is registered
+void test_help() {
+  std::string dispatched;
+  TinyCmdline cmd;
+  cmd.add_argument("alpha", 'a', [&dispatched]() { dispatched += 'a'; }, argument::none);
+  cmd.add_argument("gamma", 'c', [&dispatched](const char *value) { dispatched += value ? value : "-"; },
+                   argument::optional);
+  test_argv alone{"prog", "-a", "-h"};
+  EXPECT(cmd.try_parse(alone.argc(), alone.argv()).error == TinyCmdline::Error::help);
+  test_argv bundled{"prog", "-ah"};
+  auto result = cmd.try_parse(bundled.argc(), bundled.argv());
+  EXPECT(result.error == TinyCmdline::Error::unknown_option && result.argument == "-h");
+  EXPECT(dispatched == "aa");
+  test_argv value{"prog", "-c", "-h", "-c"};
+  result = cmd.try_parse(value.argc(), value.argv());
+  EXPECT(result.error == TinyCmdline::Error::missing_value && result.argument == "-c");
+  EXPECT(dispatched == "aa-h");
+
+  // a stream keeps its own conventions, 'h' anywhere in a bundle asks for help
+  EXPECT(cmd.try_parse_block("-ah", 3).error == TinyCmdline::Error::help);
+}
+
+}  // namespace
+
+int main() {
+  test_matches_getopt_long();
+  test_help();
+  return failed_checks != 0;
+}
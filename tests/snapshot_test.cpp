@@ -0,0 +1,68 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <cstring>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+
+namespace {
+
+// a reload sets a longer value, so the buffer of the option is reallocated under the replicas
+void test_reload_longer_string() {
+  TinyCmdline cmd;
+  auto host = cmd.add_argument<TinyCmdline::string_ref>("host", 'H');
+  auto port = cmd.add_argument<int32_t>("port", 'p');
+  test_argv first{"prog", "--host", "a", "--port", "1"};
+  EXPECT(cmd.try_parse(first.argc(), first.argv()));
+
+  TinyCmdline::Snapshot snapshot(cmd, 2);
+  const TinyCmdline::string_ref &held = snapshot[host];
+  EXPECT(held.str() == "a");
+  EXPECT(snapshot[port] == 1);
+
+  const std::string longer(200, 'b');
+  test_argv second{"prog", "--host", longer.c_str(), "--port", "2"};
+  EXPECT(cmd.try_parse(second.argc(), second.argv()));
+  EXPECT(cmd[host].str() == longer);
+  // not published yet, the current replica keeps the previous value
+  EXPECT(held.str() == "a");
+  EXPECT(strcmp(held.c_str(), "a") == 0);
+
+  snapshot.publish();
+  EXPECT(held.str() == "a");  // retired, valid until reclaim()
+  EXPECT(snapshot[host].str() == longer);
+  EXPECT(snapshot[port] == 2);
+
+  const std::string longest(1000, 'c');
+  test_argv third{"prog", "-H", longest.c_str()};
+  EXPECT(cmd.try_parse(third.argc(), third.argv()));
+  EXPECT(snapshot[host].str() == longer);
+  snapshot.publish();
+  snapshot.reclaim();
+  EXPECT(snapshot[host].str() == longest);
+  EXPECT(snapshot[host].c_str()[longest.size()] == '\0');
+}
+
+void test_replicas() {
+  TinyCmdline cmd;
+  auto workers = cmd.add_argument<uint16_t>("workers", 'w');
+  test_argv args{"prog", "-w", "16"};
+  EXPECT(cmd.try_parse(args.argc(), args.argv()));
+  TinyCmdline::Snapshot snapshot(cmd, 3);
+  EXPECT(snapshot.replicas() == 3);
+  EXPECT(snapshot[workers] == 16);
+  EXPECT(TinyCmdline::Snapshot::node_count() >= 1);
+}
+
+}  // namespace
+
+int main() {
+  test_reload_longer_string();
+  test_replicas();
+  return failed_checks != 0;
+}
@@ -0,0 +1,70 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <array>
+#include <tuple>
+#include <utility>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+
+namespace {
+
+struct display {
+  display() {
+    cmd.add_argument("window", 'w', window, TinyCmdline::split('x'), "Window size.");
+    cmd.add_argument("mode", 0, mode, TinyCmdline::split(':'), "Mode, id:scale:fullscreen.");
+    point = cmd.add_argument<std::array<double, 3>>("point", 0, TinyCmdline::split(','), "A point.");
+  }
+
+  TinyCmdline::parse_result parse(std::initializer_list<const char *> tokens) {
+    test_argv args(tokens);
+    return cmd.try_parse(args.argc(), args.argv());
+  }
+
+  TinyCmdline cmd;
+  std::pair<int32_t, int32_t> window{640, 480};
+  std::tuple<int32_t, double, bool> mode{0, 1.0, false};
+  TinyCmdline::Opt<std::array<double, 3>> point;
+};
+
+void test_elements_are_converted_in_place() {
+  display d;
+  EXPECT(d.parse({"prog", "-w", "1920x1080", "--mode=3:1.5:1", "--point", "1,-2.5,3e2"}));
+  EXPECT(d.window.first == 1920 && d.window.second == 1080);
+  EXPECT(std::get<0>(d.mode) == 3 && std::get<1>(d.mode) == 1.5 && std::get<2>(d.mode));
+  EXPECT(d.point.was_set());
+  EXPECT(d.point.get()[0] == 1.0 && d.point.get()[1] == -2.5 && d.point.get()[2] == 300.0);
+}
+
+// the value is only set when the count matches and every element converts
+void expect_rejected(std::initializer_list<const char *> tokens) {
+  display d;
+  EXPECT(d.parse(tokens).error == Error::bad_value);
+  EXPECT(d.window.first == 640 && d.window.second == 480);
+  EXPECT(std::get<0>(d.mode) == 0 && std::get<1>(d.mode) == 1.0 && !std::get<2>(d.mode));
+  EXPECT(!d.point.was_set());
+}
+
+void test_rejected_values() {
+  expect_rejected({"prog", "-w", "1920"});
+  expect_rejected({"prog", "-w", "1920x1080x3"});
+  expect_rejected({"prog", "-w", "1920xwide"});
+  expect_rejected({"prog", "-w", "x1080"});
+  expect_rejected({"prog", "--mode=3:1.5"});
+  expect_rejected({"prog", "--point=1,2,"});
+  expect_rejected({"prog", "--point=1,,3"});
+}
+
+}  // namespace
+
+int main() {
+  test_elements_are_converted_in_place();
+  test_rejected_values();
+  return failed_checks != 0;
+}
@@ -0,0 +1,156 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+struct tool {
+  tool() {
+    cmd.add_argument("count", 'c', count, "A count.");
+    cmd.add_argument("name", 'n', [this](const char *value) { name = value; }, argument::required, "A name.");
+    cmd.add_argument("include", 'I', [this](const char *const *values, size_t size) {
+      includes.assign(values, values + size);
+    }, argument::required, "Adds an include path.");
+    cmd.set_positional_handler([this](const char *value) { positional.push_back(value); });
+  }
+
+  TinyCmdline cmd;
+  int32_t count{0};
+  std::string name;
+  std::vector<std::string> includes;
+  std::vector<std::string> positional;
+};
+
+// a pipe holding the bytes, the write end is closed unless the writer stays
+struct pipe_input {
+  explicit pipe_input(const std::string &bytes, bool writer_stays = false) {
+    EXPECT(pipe(fds) == 0);
+    EXPECT(write(fds[1], bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()));
+    if (!writer_stays) {
+      close_writer();
+    }
+  }
+  ~pipe_input() {
+    close(fds[0]);
+    close_writer();
+  }
+
+  void close_writer() {
+    if (fds[1] >= 0) {
+      close(fds[1]);
+      fds[1] = -1;
+    }
+  }
+
+  int fds[2];
+};
+
+std::string nul_joined(std::initializer_list<std::string> tokens) {
+  std::string bytes;
+  for (const auto &token : tokens) {
+    bytes += token;
+    bytes += '\0';
+  }
+  return bytes;
+}
+
+void test_block() {
+  tool t;
+  const std::string block = nul_joined({"-c", "3", "input", "-I", "a", "--include=b", "--name"}) + "last";
+  EXPECT(t.cmd.try_parse_block(block.data(), block.size()));
+  EXPECT(t.count == 3);
+  EXPECT(t.name == "last");
+  EXPECT((t.includes == std::vector<std::string>{"a", "b"}));
+  EXPECT((t.positional == std::vector<std::string>{"input"}));
+}
+
+void test_block_errors() {
+  tool t;
+  std::string block = nul_joined({"-I", "a", "--bogus", "-c", "3"});
+  auto result = t.cmd.try_parse_block(block.data(), block.size());
+  EXPECT(result.error == Error::unknown_option && result.argument == "--bogus");
+  EXPECT(t.count == 0);
+  EXPECT(t.includes.empty());
+
+  block = nul_joined({"-c"});
+  result = t.cmd.try_parse_block(block.data(), block.size());
+  EXPECT(result.error == Error::missing_value && result.argument == "--count");
+
+  TinyCmdline strict;
+  int32_t count = 0;
+  strict.add_argument("count", 'c', count);
+  block = nul_joined({"-c", "1", "stray"});
+  result = strict.try_parse_block(block.data(), block.size());
+  EXPECT(result.error == Error::positional && result.argument == "stray");
+}
+
+// the chunks are read one at a time, a token may span several of them
+void test_fd() {
+  tool t;
+  const std::string long_name(3 * TinyCmdline::stream_chunk_size, 'x');
+  std::string bytes;
+  for (int i = 0; i < 1000; ++i) {
+    bytes += nul_joined({"-I", std::to_string(i)});
+  }
+  bytes += nul_joined({"--name", long_name, "-c"}) + "7";
+  pipe_input input(bytes);
+  EXPECT(t.cmd.try_parse_fd(input.fds[0]));
+  EXPECT(t.includes.size() == 1000 && t.includes[999] == "999");
+  EXPECT(t.name == long_name);
+  EXPECT(t.count == 7);
+}
+
+void on_alarm(int) {
+  static const char message[] = "try_parse_fd kept reading after an error\n";
+  (void)!write(STDERR_FILENO, message, sizeof(message) - 1);
+  _exit(1);
+}
+
+// an error in the first chunk returns at once, while the writer, e.g. a console, still holds the pipe open
+void test_fd_error_stops_reading() {
+  tool t;
+  signal(SIGALRM, on_alarm);
+  alarm(5);
+  pipe_input input(nul_joined({"-c", "1", "--bogus", "-c", "2"}), true);
+  const auto result = t.cmd.try_parse_fd(input.fds[0]);
+  alarm(0);
+  EXPECT(result.error == Error::unknown_option && result.argument == "--bogus");
+  EXPECT(t.count == 1);
+
+  pipe_input bad_value(nul_joined({"--count=ten"}), true);
+  alarm(5);
+  EXPECT(t.cmd.try_parse_fd(bad_value.fds[0]).error == Error::bad_value);
+  alarm(0);
+}
+
+void test_fd_read_failure() {
+  tool t;
+  const auto result = t.cmd.try_parse_fd(-1);
+  EXPECT(result.error == Error::io);
+}
+
+}  // namespace
+
+int main() {
+  test_block();
+  test_block_errors();
+  test_fd();
+  test_fd_error_stops_reading();
+  test_fd_read_failure();
+  return failed_checks != 0;
+}
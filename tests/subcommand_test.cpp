@@ -0,0 +1,96 @@
+/*
+  MIT License
+*/
+
+#include "tiny_cmdline.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using tiny_cmdline::TinyCmdline;
+using Error = TinyCmdline::Error;
+using argument = TinyCmdline::Argument;
+
+namespace {
+
+struct tool {
+  tool() : build(&global) {
+    global.add_argument("verbose", 'v', [this]() { ++verbose; }, argument::none, "More output.");
+    global.add_argument("jobs", 'j', jobs, "The global number of jobs.");
+    global.add_argument("include", 'I', [this](const char *const *values, size_t count) {
+      includes.assign(values, values + count);
+    }, argument::required, "Adds an include path.");
+    color = global.add_argument<int32_t>("color", 0, "Colored output.");
+    build.add_argument("target", 't', target, "The target to build.");
+    // hides the parent option with the same names
+    build.add_argument("jobs", 'j', build_jobs, "The number of build jobs.");
+  }
+
+  TinyCmdline global;
+  TinyCmdline build;
+  int32_t verbose{0};
+  int32_t jobs{0};
+  int32_t build_jobs{0};
+  int32_t target{0};
+  std::vector<std::string> includes;
+  TinyCmdline::Opt<int32_t> color;
+};
+
+void test_child_inherits_the_parent_options() {
+  tool t;
+  test_argv args{"build", "-vv", "--target", "3", "-I", "a", "--include=b", "--color=2", "-j4"};
+  EXPECT(t.build.try_parse(args.argc(), args.argv()));
+  EXPECT(t.verbose == 2);
+  EXPECT(t.target == 3);
+  EXPECT((t.includes == std::vector<std::string>{"a", "b"}));
+  // an inherited handle reads the parent value
+  EXPECT(t.color.was_set() && t.color.get() == 2);
+  EXPECT(t.build_jobs == 4 && t.jobs == 0);
+}
+
+void test_parent_does_not_see_the_child_options() {
+  tool t;
+  test_argv args{"prog", "-j2", "--target=1"};
+  const auto result = t.global.try_parse(args.argc(), args.argv());
+  EXPECT(result.error == Error::unknown_option && result.argument == "--target=1");
+  EXPECT(t.target == 0);
+}
+
+void test_child_errors() {
+  tool t;
+  test_argv unknown{"build", "-v", "--bogus"};
+  auto result = t.build.try_parse(unknown.argc(), unknown.argv());
+  EXPECT(result.error == Error::unknown_option && result.argument == "--bogus");
+
+  // an inherited bulk option drops its values with the failed parse
+  test_argv bad{"build", "-I", "a", "--color=red"};
+  result = t.build.try_parse(bad.argc(), bad.argv());
+  EXPECT(result.error == Error::bad_value && result.detail == "--color");
+  EXPECT(t.includes.empty());
+  EXPECT(!t.color.was_set());
+}
+
+// the streaming parsers of a child dispatch the inherited options to the parent as well
+void test_child_streams() {
+  tool t;
+  TinyCmdline::PushParser<> pusher(t.build, " ");
+  for (int command = 0; command < 2; ++command) {
+    t.includes.clear();
+    pusher.feed("-I x -I yy -t 5 -v", 18);
+    EXPECT(pusher.finish());
+    EXPECT((t.includes == std::vector<std::string>{"x", "yy"}));
+  }
+  EXPECT(t.target == 5 && t.verbose == 2);
+}
+
+}  // namespace
+
+int main() {
+  test_child_inherits_the_parent_options();
+  test_parent_does_not_see_the_child_options();
+  test_child_errors();
+  test_child_streams();
+  return failed_checks != 0;
+}
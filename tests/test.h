@@ -0,0 +1,51 @@
+/*
+  MIT License
+*/
+
+// Checks shared by the tests, each test is a program exiting with 1 if a check failed.
+
+#ifndef TINY_CMDLINE_TEST_H
+#define TINY_CMDLINE_TEST_H
+
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+static int failed_checks = 0;
+
+#define EXPECT(condition)                                                          \
+  do {                                                                             \
+    if (!(condition)) {                                                            \
+      fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition);     \
+      ++failed_checks;                                                             \
+    }                                                                              \
+  } while (0)
+
+/**
+ * A writable argv, the parsers permute it.
+ */
+class test_argv {
+ public:
+  test_argv(std::initializer_list<const char *> tokens) : tokens_(tokens.begin(), tokens.end()) { reset(); }
+  explicit test_argv(const std::vector<std::string> &tokens) : tokens_(tokens) { reset(); }
+
+  // restores the original order
+  void reset() {
+    pointers_.clear();
+    for (auto &token : tokens_) {
+      pointers_.push_back(&token[0]);
+    }
+    pointers_.push_back(nullptr);
+  }
+
+  int argc() const { return static_cast<int>(tokens_.size()); }
+  char **argv() { return pointers_.data(); }
+  const char *operator[](size_t i) const { return pointers_[i]; }
+
+ private:
+  std::vector<std::string> tokens_;
+  std::vector<char *> pointers_;
+};
+
+#endif  // TINY_CMDLINE_TEST_H
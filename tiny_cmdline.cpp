@@ -0,0 +1,24 @@
+/*
+  MIT License
+*/
+
+// The compiled part of tiny_cmdline.h, for builds defining TINY_CMDLINE_COMPILED_LIB. The parser and the common
+// conversions are compiled once here instead of in every translation unit including the header.
+//
+// $ g++ -std=c++11 -O2 -DTINY_CMDLINE_COMPILED_LIB -c tiny_cmdline.cpp
+
+#ifndef TINY_CMDLINE_COMPILED_LIB
+#define TINY_CMDLINE_COMPILED_LIB
+#endif
+#define TINY_CMDLINE_IMPLEMENTATION
+#include "tiny_cmdline.h"
+
+namespace tiny_cmdline {
+
+#define TINY_CMDLINE_INSTANTIATE(T)                                   \
+  template bool TinyCmdline::convert<T>::try_to(const char *, T &); \
+  template bool TinyCmdline::assign_field<T>(void *, const char *);
+TINY_CMDLINE_COMMON_TYPES(TINY_CMDLINE_INSTANTIATE)
+#undef TINY_CMDLINE_INSTANTIATE
+
+}  // namespace tiny_cmdline
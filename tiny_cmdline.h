@@ -5,184 +5,4445 @@
 #ifndef TINY_CMDLINE_H
 #define TINY_CMDLINE_H
 
-#include <getopt.h>
-
+#include <cerrno>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
-#include <functional>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <new>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+// with TINY_CMDLINE_COMPILED_LIB the parser is compiled once in tiny_cmdline.cpp instead of in every translation unit
+#ifdef TINY_CMDLINE_COMPILED_LIB
+#define TINY_CMDLINE_INLINE
+#else
+#define TINY_CMDLINE_INLINE inline
+#endif
+
+// conversions and parsing report errors with codes instead of exceptions when exceptions are disabled
+#if !defined(TINY_CMDLINE_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS)
+#define TINY_CMDLINE_NO_EXCEPTIONS
+#endif
+
+// the parser is declared in an inline namespace named after the mode, so a program mixing header-only and
+// TINY_CMDLINE_COMPILED_LIB translation units, two different definitions of TinyCmdline, fails to link
+#ifdef TINY_CMDLINE_COMPILED_LIB
+#define TINY_CMDLINE_MODE compiled_lib
+#else
+#define TINY_CMDLINE_MODE header_only
+#endif
+
 namespace tiny_cmdline {
+inline namespace TINY_CMDLINE_MODE {
+template <size_t MaxOptions, size_t MaxHelpSize> class FixedCmdline;
+
 class TinyCmdline {  // shortname 'h' and longname "help" are reserved for help
  public:
-  enum class Argument {
-    none = no_argument,
-    required = required_argument,
-    optional = optional_argument,
+  enum class Argument {  // the has_arg values of getopt_long
+    none = 0,
+    required = 1,
+    optional = 2,  // --name=value, -ovalue, or -o value in argv like "o:" for getopt, streams take only -ovalue
   };
 
- private:
-  using operator_t = std::function<void(const char *)>;
-  using void_operator_t = std::function<void()>;
-  struct operator_option {
-    char short_name;
-    std::string long_name;
-    operator_t op;  // operator function, takes the argument value as a parameter
-    std::string help;
-    Argument type;
+  enum class Error {
+    none,
+    help,              // -h or --help was given
+    unknown_option,
+    missing_value,     // a required value is missing
+    unexpected_value,  // a value was given to an option taking none
+    bad_value,         // the value failed to convert or its check
+    too_long,          // a token exceeds the buffer of a PushParser, see also add_prefix_argument()
+    constraint,        // a constraint failed, the argument lists every violation, one per line
+    not_overridable,   // an Overlay only overrides the values read through a handle
+    io,                // a stream value or the input could not be read, the argument says why, like perror()
+    positional,        // a streamed positional argument without a handler, see set_positional_handler()
   };
 
-  static operator_t convert_operator_f(operator_t &&f) { return std::forward<operator_t>(f); }
-  static operator_t convert_operator_f(void_operator_t &&f) {
-    // the attribute  is supported since C++17, I wrote this for placeholder
-    return [f]([[maybe_unused]] const char *) { f(); };
-  }
+  /**
+   * Result of a parse, converts to true on success.
+   */
+  struct parse_result {
+    parse_result(Error error = Error::none, std::string argument = {}, std::string detail = {})  // NOLINT
+        : error(error), argument(std::move(argument)), detail(std::move(detail)) {}
+
+    Error error;
+    std::string argument;  // the argument that failed
+    std::string detail;    // for Error::bad_value, the option and the check it broke, e.g. "--val: not in [0, 100]"
+
+    explicit operator bool() const { return error == Error::none; }
+  };
 
- public:
   /**
-   * Converts the argument value to the desired type. Specializations can be added for custom types.
-   *
-   * @tparam T The desired type.
+   * Source of the memory of a parser, the C++11 counterpart of std::pmr::memory_resource. The containers and strings
+   * of a parser created with TinyCmdline(memory_resource *) all allocate from it.
    */
-  template <typename T> struct convert {
-    static T to(const char *optarg) { return static_cast<T>(std::stoll(optarg)); }
+  class memory_resource {
+   public:
+    virtual ~memory_resource() = default;
+    virtual void *allocate(size_t bytes, size_t align) = 0;
+    virtual void deallocate(void *p, size_t bytes, size_t align) = 0;
   };
 
   /**
-   * Prints the help information.
+   * The resource of the parsers created without one, operator new and delete.
    */
-  void print_help() {
-    for (const auto &option : operators_) {
-      if (option.second.short_name == 'h' || option.second.long_name == "help") {
-        option.second.op(nullptr);
-        return;
+  static memory_resource *default_resource() {
+    static new_delete_resource resource;
+    return &resource;
+  }
+
+  /**
+   * Resource handing out memory from a buffer, then from blocks of growing size taken from an upstream resource.
+   * Deallocation does nothing, everything is released at once by release() or the destructor, e.g. at the end of a
+   * request. Not thread-safe, use one per thread or per request.
+   */
+  class monotonic_resource : public memory_resource {
+   public:
+    /**
+     * @param block_size The size of the first block taken from upstream, the next ones double.
+     * @param upstream The resource of the blocks.
+     */
+    explicit monotonic_resource(size_t block_size = 4096, memory_resource *upstream = default_resource())
+        : upstream_(upstream), block_size_(block_size), next_size_(block_size) {}
+
+    /**
+     * @param buffer The memory used first, e.g. on the stack, so a small parse never reaches upstream.
+     * @param size The size of the buffer.
+     * @param upstream The resource of the blocks once the buffer is full.
+     */
+    monotonic_resource(void *buffer, size_t size, memory_resource *upstream = default_resource())
+        : upstream_(upstream),
+          block_size_(size),
+          next_size_(size),
+          buffer_(static_cast<unsigned char *>(buffer)),
+          buffer_size_(size),
+          cursor_(buffer_),
+          end_(buffer_ + size) {}
+
+    monotonic_resource(const monotonic_resource &) = delete;
+    monotonic_resource &operator=(const monotonic_resource &) = delete;
+    ~monotonic_resource() override { release(); }
+
+    void *allocate(size_t bytes, size_t align) override {
+      auto aligned = align_(cursor_, align);
+      if (cursor_ == nullptr || aligned + bytes > reinterpret_cast<uintptr_t>(end_)) {
+        const size_t size = (bytes + align > next_size_) ? bytes + align : next_size_;
+        void *memory = upstream_->allocate(sizeof(block_header) + size, alignof(block_header));
+        auto *block = static_cast<block_header *>(memory);
+        *block = block_header{blocks_, size};
+        blocks_ = block;
+        cursor_ = reinterpret_cast<unsigned char *>(block + 1);
+        end_ = cursor_ + size;
+        next_size_ = size * 2;
+        aligned = align_(cursor_, align);
       }
+      cursor_ = reinterpret_cast<unsigned char *>(aligned + bytes);
+      return reinterpret_cast<void *>(aligned);
+    }
+
+    void deallocate(void *, size_t, size_t) override {}
+
+    /**
+     * Releases all the memory at once, nothing allocated from the resource may be used afterwards.
+     */
+    void release() {
+      while (blocks_ != nullptr) {
+        block_header *next = blocks_->next;
+        upstream_->deallocate(blocks_, sizeof(block_header) + blocks_->size, alignof(block_header));
+        blocks_ = next;
+      }
+      cursor_ = buffer_;
+      end_ = buffer_ + buffer_size_;
+      next_size_ = block_size_;
+    }
+
+   private:
+    struct alignas(std::max_align_t) block_header {
+      block_header *next;
+      size_t size;  // usable bytes after the header
+    };
+
+    static uintptr_t align_(const unsigned char *p, size_t align) {
+      return (reinterpret_cast<uintptr_t>(p) + align - 1) & ~static_cast<uintptr_t>(align - 1);
     }
-    usage_();
-  }
+
+    memory_resource *upstream_;
+    size_t block_size_;
+    size_t next_size_;
+    unsigned char *buffer_{nullptr};
+    size_t buffer_size_{0};
+    unsigned char *cursor_{nullptr};
+    unsigned char *end_{nullptr};
+    block_header *blocks_{nullptr};
+  };
 
   /**
-   * Parses the command line arguments.
-   *
-   * @param argc The number of command line arguments.
-   * @param argv The command line arguments.
+   * Read-only view of a string value stored by a parser, the C++11 counterpart of std::string_view. The characters
+   * of a stored value are NUL-terminated, so c_str() can be passed to C functions. The long name passed to a prefix
+   * handler views its token up to the '=' and is not terminated, read it with data() and size(). A string_ref option
+   * copies its value into a buffer of the option, reused when the option is set again, instead of allocating a
+   * std::string per value. The view stays valid until the option is set again, a Snapshot copies the characters into
+   * its replicas. An Overlay override views its token instead.
    */
-  void parse(int argc, char *argv[]) {
-    std::string short_options;
-    std::vector<option> long_options;
-    for (const auto &option_it : operators_) {
-      const auto &option = option_it.second;
-      if (option.short_name != '\0') {
-        short_options = short_options + option.short_name + (option.type != Argument::none ? ":" : "");
+  class string_ref {
+   public:
+    string_ref() = default;
+    string_ref(const char *data, size_t size) : data_(data), size_(size) {}
+    string_ref(const char *data) : data_(data ? data : ""), size_(data ? strlen(data) : 0) {}  // NOLINT, like a view
+    template <typename Allocator>
+    string_ref(const std::basic_string<char, std::char_traits<char>, Allocator> &s)  // NOLINT, like a view
+        : data_(s.data()), size_(s.size()) {}
+
+    const char *data() const { return data_; }
+    const char *c_str() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char *begin() const { return data_; }
+    const char *end() const { return data_ + size_; }
+    char operator[](size_t i) const { return data_[i]; }
+    std::string str() const { return std::string(data_, size_); }
+
+    friend bool operator==(const string_ref &a, const string_ref &b) {
+      return a.size_ == b.size_ && (a.data_ == b.data_ || memcmp(a.data_, b.data_, a.size_) == 0);
+    }
+    friend bool operator!=(const string_ref &a, const string_ref &b) { return !(a == b); }
+    friend bool operator<(const string_ref &a, const string_ref &b) {
+      const int order = memcmp(a.data_, b.data_, (a.size_ < b.size_) ? a.size_ : b.size_);
+      return order < 0 || (order == 0 && a.size_ < b.size_);
+    }
+
+   private:
+    const char *data_{""};
+    size_t size_{0};
+  };
+
+  class Overlay;
+  class Snapshot;
+
+ private:
+  class new_delete_resource : public memory_resource {
+   public:
+    void *allocate(size_t bytes, size_t) override { return ::operator new(bytes); }
+    void deallocate(void *p, size_t, size_t) override { ::operator delete(p); }
+  };
+
+  // standard allocator over a memory_resource, the containers carry it along when moved or swapped
+  template <typename T> class resource_allocator {
+   public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    resource_allocator() : resource_(default_resource()) {}
+    resource_allocator(memory_resource *resource) : resource_(resource) {}  // NOLINT, like a pmr allocator
+    template <typename U> resource_allocator(const resource_allocator<U> &other) : resource_(other.resource()) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *p, size_t n) { resource_->deallocate(p, n * sizeof(T), alignof(T)); }
+    memory_resource *resource() const { return resource_; }
+
+    template <typename U> bool operator==(const resource_allocator<U> &other) const {
+      return resource_ == other.resource();
+    }
+    template <typename U> bool operator!=(const resource_allocator<U> &other) const {
+      return resource_ != other.resource();
+    }
+
+   private:
+    memory_resource *resource_;
+  };
+
+  using string_t = std::basic_string<char, std::char_traits<char>, resource_allocator<char>>;
+  template <typename T> using vector_t = std::vector<T, resource_allocator<T>>;
+  template <typename K, typename V>
+  using map_t = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, resource_allocator<std::pair<const K, V>>>;
+
+  /**
+   * Small-buffer callable used instead of std::function for the operators. Callables up to inline_size bytes, e.g.
+   * lambdas capturing a few references, are stored inline, larger ones on the heap. A call is a single indirect call
+   * and every type instantiates only an invoker and a manager function.
+   */
+  template <typename Signature> class callable;
+  template <typename R, typename... Args> class callable<R(Args...)> {
+   public:
+    static constexpr size_t inline_size = 4 * sizeof(void *);
+
+    callable() = default;
+    callable(std::nullptr_t) {}  // NOLINT, converts like std::function
+    template <typename F, typename D = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<D, callable>::value>::type,
+              typename = decltype(std::declval<D &>()(std::declval<Args>()...))>
+    callable(F &&f) {  // NOLINT, converts like std::function
+      emplace_<D>(std::forward<F>(f), &invoke_with_<D>);
+    }
+    callable(const callable &other) { copy_from_(other); }
+    callable(callable &&other) noexcept { move_from_(other); }
+    callable &operator=(const callable &other) {
+      if (this != &other) {
+        reset_();
+        copy_from_(other);
       }
-      if (!option.long_name.empty()) {
-        long_options.push_back({option.long_name.c_str(), static_cast<int32_t>(option.type), nullptr, option_it.first});
+      return *this;
+    }
+    callable &operator=(callable &&other) noexcept {
+      if (this != &other) {
+        reset_();
+        move_from_(other);
       }
+      return *this;
     }
-    long_options.push_back({nullptr, 0, nullptr, 0});
+    ~callable() { reset_(); }
 
-    int32_t c = 0;
-    int32_t option_index = 0;
-    const int32_t opterr_tmp = opterr;
-    opterr = 0;
-    while ((c = getopt_long(argc, argv, short_options.c_str(), long_options.data(), &option_index)) != -1) {
-      // if is a help command
-      if (c == 'h' || std::string(argv[optind - 1]) == "--help" || std::string(argv[optind - 1]) == "-h") {
-        print_help();
-        exit(0);
+    /**
+     * Wraps a callable taking no parameters, the arguments are dropped by the invoker itself instead of by a
+     * second wrapper.
+     */
+    template <typename F> static callable dropping_arguments(F &&f) {
+      callable result;
+      result.template emplace_<typename std::decay<F>::type>(std::forward<F>(f),
+                                                             &invoke_without_<typename std::decay<F>::type>);
+      return result;
+    }
+
+    /**
+     * Whether a callable of type F is stored inline, i.e. wrapping it never allocates.
+     */
+    template <typename F> static constexpr bool stores_inline() {
+      return is_inline_t<typename std::decay<F>::type>::value;
+    }
+
+    R operator()(Args... args) const { return invoke_(*this, std::forward<Args>(args)...); }
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+   private:
+    enum class operation { copy, move, destroy };
+    using invoke_t = R (*)(const callable &, Args...);
+    using manage_t = void (*)(operation, callable &, const callable *);
+
+    // whether F is stored in storage_, otherwise storage_ holds a pointer to a heap copy
+    template <typename F>
+    using is_inline_t = std::integral_constant<bool, sizeof(F) <= inline_size &&
+                                                         alignof(F) <= alignof(std::max_align_t) &&
+                                                         std::is_nothrow_move_constructible<F>::value>;
+
+    template <typename F> static F *get_(const callable &c) { return get_<F>(c, is_inline_t<F>()); }
+    template <typename F> static F *get_(const callable &c, std::true_type) {
+      return reinterpret_cast<F *>(const_cast<unsigned char *>(c.storage_));
+    }
+    template <typename F> static F *get_(const callable &c, std::false_type) {
+      return *reinterpret_cast<F *const *>(c.storage_);
+    }
+
+    template <typename F> static R invoke_with_(const callable &c, Args... args) {
+      return (*get_<F>(c))(std::forward<Args>(args)...);
+    }
+    template <typename F> static R invoke_without_(const callable &c, Args...) { return (*get_<F>(c))(); }
+
+    template <typename F> static void manage_with_(operation op, callable &dst, const callable *src) {
+      switch (op) {
+        case operation::copy:
+          construct_<F>(dst, *get_<F>(*src));
+          break;
+        case operation::move:
+          move_<F>(dst, *src, is_inline_t<F>());
+          break;
+        case operation::destroy:
+          destroy_<F>(dst, is_inline_t<F>());
+          break;
+      }
+    }
+
+    template <typename F, typename G> static void construct_(callable &dst, G &&f) {
+      construct_<F>(dst, std::forward<G>(f), is_inline_t<F>());
+    }
+    template <typename F, typename G> static void construct_(callable &dst, G &&f, std::true_type) {
+      new (dst.storage_) F(std::forward<G>(f));
+    }
+    template <typename F, typename G> static void construct_(callable &dst, G &&f, std::false_type) {
+      F *heap = new F(std::forward<G>(f));
+      memcpy(dst.storage_, &heap, sizeof(F *));
+    }
+
+    template <typename F> static void move_(callable &dst, const callable &src, std::true_type) {
+      new (dst.storage_) F(std::move(*get_<F>(src)));
+      get_<F>(src)->~F();
+    }
+    // the source gives up the heap copy, it is reset without destroying it
+    template <typename F> static void move_(callable &dst, const callable &src, std::false_type) {
+      memcpy(dst.storage_, src.storage_, sizeof(F *));
+    }
+
+    template <typename F> static void destroy_(callable &dst, std::true_type) { get_<F>(dst)->~F(); }
+    template <typename F> static void destroy_(callable &dst, std::false_type) { delete get_<F>(dst); }
+
+    template <typename F, typename G> void emplace_(G &&f, invoke_t invoke) {
+      construct_<F>(*this, std::forward<G>(f));
+      invoke_ = invoke;
+      manage_ = &manage_with_<F>;
+    }
+
+    void copy_from_(const callable &other) {
+      if (other.invoke_ != nullptr) {
+        other.manage_(operation::copy, *this, &other);
+        invoke_ = other.invoke_;
+        manage_ = other.manage_;
       }
-      if (c == '?') {
-        print_help();
-        exit(1);
+    }
+    void move_from_(callable &other) {
+      if (other.invoke_ != nullptr) {
+        other.manage_(operation::move, *this, &other);
+        invoke_ = other.invoke_;
+        manage_ = other.manage_;
+        other.invoke_ = nullptr;
+        other.manage_ = nullptr;
+      }
+    }
+    void reset_() {
+      if (invoke_ != nullptr) {
+        manage_(operation::destroy, *this, nullptr);
+        invoke_ = nullptr;
+        manage_ = nullptr;
       }
-      // options are generated from operators_, so we can safely use the short name as the key
-      operators_[c].op(optarg);
     }
-    opterr = opterr_tmp;
-  }
 
-  /**
-   * Adds an argument to the command line parser.
-   *
-   * @param long_name The long name of the argument.
-   * @param short_name The short name of the argument.
-   * @param f The operator function associated with the argument, which takes the argument value as a parameter.
-   * @param type The type of the argument (default: Argument::Required).
-   * @param help The help text for the argument (default: "").
-   */
-  template <typename T>
-  void add_argument(const std::string &long_name, char short_name, T &&f, Argument type, const std::string &help = "") {
-    using decay_f = typename std::decay<T>::type;
-    constexpr bool is_operator_f = std::is_convertible<decay_f, operator_t>::value;
-    constexpr bool is_void_operator_f = std::is_convertible<decay_f, void_operator_t>::value;
-    static_assert(is_operator_f || is_void_operator_f, "The operator function must be operator_t or void_operator_t.");
+    alignas(std::max_align_t) unsigned char storage_[inline_size];
+    invoke_t invoke_{nullptr};
+    manage_t manage_{nullptr};
+  };
+
+  using operator_t = callable<void(const char *)>;
+  using void_operator_t = callable<void()>;
+  using stream_operator_t = callable<void(const char *, size_t)>;
+  using bulk_operator_t = callable<void(const char *const *, size_t)>;
+  using prefix_operator_t = callable<void(string_ref, const char *)>;
+  struct operator_option {
+    char short_name;
+    string_t long_name;
+    operator_t op;  // operator function, takes the argument value as a parameter
+    string_t help;
+    Argument type;
+    bulk_operator_t bulk;           // set instead of op, called once after scanning with all the values
+    stream_operator_t stream;       // set instead of op, receives the value in chunks, see stream_value_()
+    vector_t<const char *> values;  // values collected for bulk, in the order of the arguments
+    uint32_t slot;                     // dense index of the option, in registration order
+    bool (*assign)(void *, const char *);  // set instead of op for typed values, converts the value into target
+    void *target;
+    void (*explain)(const void *, const char *, std::string &);  // why assign rejected a value, nullptr if unknown
+  };
+
+  // parser-owned storage of typed values, in cache-line aligned blocks that never move once allocated
+  class value_arena {
+   public:
+    explicit value_arena(memory_resource *resource = default_resource()) : blocks_(resource), destructors_(resource) {}
+    value_arena(const value_arena &) = delete;
+    value_arena &operator=(const value_arena &) = delete;
+    value_arena(value_arena &&) = default;
+    value_arena &operator=(value_arena &&other) {
+      blocks_.swap(other.blocks_);
+      destructors_.swap(other.destructors_);
+      std::swap(cursor_, other.cursor_);
+      std::swap(end_, other.end_);
+      return *this;
+    }
+    ~value_arena() {
+      for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+        it->second(it->first);
+      }
+      for (const auto &block : blocks_) {
+        blocks_.get_allocator().resource()->deallocate(block.first, block.second, alignof(std::max_align_t));
+      }
+    }
+
+    template <typename T, typename... Args> T *create(Args &&...args) {
+      static_assert(alignof(T) <= cache_line_size, "The value type is over-aligned.");
+      T *value = new (allocate_(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+      if (!std::is_trivially_destructible<T>::value) {
+        destructors_.emplace_back(value, [](void *p) { static_cast<T *>(p)->~T(); });
+      }
+      return value;
+    }
+
+   private:
+    static constexpr size_t cache_line_size = 64;
+    static constexpr size_t block_size = 4096;
+
+    void *allocate_(size_t size, size_t align) {
+      auto aligned = reinterpret_cast<uintptr_t>(cursor_);
+      aligned = (aligned + align - 1) & ~static_cast<uintptr_t>(align - 1);
+      if (cursor_ == nullptr || aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+        size_t capacity = block_size;
+        if (size > capacity) {
+          capacity = size;
+        }
+        const size_t block_bytes = capacity + cache_line_size - 1;
+        blocks_.emplace_back(blocks_.get_allocator().resource()->allocate(block_bytes, alignof(std::max_align_t)),
+                             block_bytes);
+        aligned = reinterpret_cast<uintptr_t>(blocks_.back().first);
+        aligned = (aligned + cache_line_size - 1) & ~static_cast<uintptr_t>(cache_line_size - 1);
+        end_ = reinterpret_cast<unsigned char *>(aligned + capacity);
+      }
+      cursor_ = reinterpret_cast<unsigned char *>(aligned + size);
+      return reinterpret_cast<void *>(aligned);
+    }
+
+    vector_t<std::pair<void *, size_t>> blocks_;  // allocated from the resource of the parser, with their size
+    vector_t<std::pair<void *, void (*)(void *)>> destructors_;
+    unsigned char *cursor_{nullptr};
+    unsigned char *end_{nullptr};
+  };
+
+  // copies of string values appended to blocks that never move until clear(), interned on request so a repeated
+  // value is stored once, see set_string_interning()
+  class string_pool {
+   public:
+    explicit string_pool(memory_resource *resource = default_resource()) : blocks_(resource), table_(resource) {}
+    string_pool(const string_pool &) = delete;
+    string_pool &operator=(const string_pool &) = delete;
+    string_pool(string_pool &&other) : blocks_(other.blocks_.get_allocator()), table_(other.table_.get_allocator()) {
+      *this = std::move(other);
+    }
+    string_pool &operator=(string_pool &&other) {
+      blocks_.swap(other.blocks_);
+      table_.swap(other.table_);
+      std::swap(used_, other.used_);
+      std::swap(cursor_, other.cursor_);
+      std::swap(end_, other.end_);
+      std::swap(count_, other.count_);
+      std::swap(interning_, other.interning_);
+      return *this;
+    }
+    ~string_pool() {
+      for (const auto &block : blocks_) {
+        blocks_.get_allocator().resource()->deallocate(block.first, block.second, 1);
+      }
+    }
+
+    void set_interning(bool interning) { interning_ = interning; }
+
+    string_ref store(const char *data, size_t size) {
+      if (!interning_) {
+        return copy_(data, size);
+      }
+      if ((count_ + 1) * 4 > table_.size() * 3) {
+        grow_();
+      }
+      const uint32_t hash = hash_name(data, size, 0);
+      const size_t mask = table_.size() - 1;
+      for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        auto &entry = table_[i];
+        if (entry.data == nullptr) {
+          const string_ref stored = copy_(data, size);
+          entry = interned{stored.data(), size, hash};
+          ++count_;
+          return stored;
+        }
+        if (entry.hash == hash && entry.size == size && memcmp(entry.data, data, size) == 0) {
+          return string_ref(entry.data, size);
+        }
+      }
+    }
+
+    // forgets the strings, the blocks are kept for the next ones
+    void clear() {
+      used_ = 0;
+      cursor_ = nullptr;
+      end_ = nullptr;
+      if (count_ != 0) {
+        for (auto &entry : table_) {
+          entry = interned{nullptr, 0, 0};
+        }
+        count_ = 0;
+      }
+    }
+
+   private:
+    static constexpr size_t block_size = 4096;
+
+    struct interned {
+      const char *data;  // nullptr for an empty bucket
+      size_t size;
+      uint32_t hash;
+    };
+
+    string_ref copy_(const char *data, size_t size) {
+      char *copy = allocate_(size + 1);
+      memcpy(copy, data, size);
+      copy[size] = '\0';
+      return string_ref(copy, size);
+    }
+
+    char *allocate_(size_t size) {
+      while (static_cast<size_t>(end_ - cursor_) < size) {
+        if (used_ == blocks_.size()) {
+          const size_t capacity = (size > block_size) ? size : block_size;
+          blocks_.emplace_back(static_cast<char *>(blocks_.get_allocator().resource()->allocate(capacity, 1)),
+                               capacity);
+        }
+        cursor_ = blocks_[used_].first;
+        end_ = cursor_ + blocks_[used_].second;
+        ++used_;
+      }
+      char *result = cursor_;
+      cursor_ += size;
+      return result;
+    }
+
+    // doubles the open-addressed table, the strings themselves do not move
+    void grow_() {
+      vector_t<interned> table(table_.empty() ? 16 : table_.size() * 2, interned{nullptr, 0, 0},
+                               table_.get_allocator());
+      const size_t mask = table.size() - 1;
+      for (const auto &entry : table_) {
+        if (entry.data != nullptr) {
+          size_t i = entry.hash & mask;
+          while (table[i].data != nullptr) {
+            i = (i + 1) & mask;
+          }
+          table[i] = entry;
+        }
+      }
+      table_.swap(table);
+    }
+
+    vector_t<std::pair<char *, size_t>> blocks_;  // allocated from the resource of the parser, with their size
+    vector_t<interned> table_;                     // the interned strings, empty until interning is used
+    size_t used_{0};                               // blocks in use, the next ones are reused after clear()
+    char *cursor_{nullptr};
+    char *end_{nullptr};
+    size_t count_{0};
+    bool interning_{false};
+  };
+
+  // handler of the options under a namespace, e.g. --log.* for --log.sink.file.path
+  struct prefix_option {
+    string_t prefix;
+    prefix_operator_t op;  // takes the full long name and the argument value
+    string_t help;
+    Argument type;
+  };
+
+  // compressed trie of the long names, a single walk per token resolves an option or the longest prefix handler
+  class name_trie {
+   public:
+    struct match {
+      int32_t key;     // key of the option with this exact name, -1 if none
+      int32_t prefix;  // index of the longest prefix handler covering the name, -1 if none
+    };
+
+    explicit name_trie(memory_resource *resource = default_resource())
+        : nodes_(1, node{string_t(resource), vector_t<uint32_t>(resource), -1, -1}, resource) {}
+
+    void insert(const char *name, size_t len, int32_t value, bool is_prefix) {
+      memory_resource *resource = nodes_.get_allocator().resource();
+      uint32_t current = 0;
+      size_t pos = 0;
+      while (pos < len) {
+        const int32_t child = find_child_(current, name[pos]);
+        if (child < 0) {
+          nodes_.push_back(node{string_t(name + pos, len - pos, resource), vector_t<uint32_t>(resource), -1, -1});
+          nodes_[current].children.push_back(static_cast<uint32_t>(nodes_.size() - 1));
+          current = static_cast<uint32_t>(nodes_.size() - 1);
+          break;
+        }
+        const auto next = static_cast<uint32_t>(child);
+        const string_t &label = nodes_[next].label;
+        size_t common = 0;
+        while (common < label.size() && pos + common < len && label[common] == name[pos + common]) {
+          ++common;
+        }
+        if (common < label.size()) {
+          // split the edge, the new node takes the common part of the label
+          nodes_.push_back(node{string_t(label, 0, common, resource), vector_t<uint32_t>(1, next, resource), -1, -1});
+          nodes_[next].label.erase(0, common);
+          const auto split = static_cast<uint32_t>(nodes_.size() - 1);
+          for (auto &sibling : nodes_[current].children) {
+            sibling = (sibling == next) ? split : sibling;
+          }
+          current = split;
+        } else {
+          current = next;
+        }
+        pos += common;
+      }
+      (is_prefix ? nodes_[current].prefix : nodes_[current].key) = value;
+    }
+
+    match find(const char *name, size_t len) const {
+      match result{-1, -1};
+      uint32_t current = 0;
+      size_t pos = 0;
+      while (true) {
+        const node &n = nodes_[current];
+        if (n.prefix >= 0 && pos < len) {
+          result.prefix = n.prefix;
+        }
+        if (pos == len) {
+          result.key = n.key;
+          return result;
+        }
+        const int32_t child = find_child_(current, name[pos]);
+        if (child < 0) {
+          return result;
+        }
+        const string_t &label = nodes_[static_cast<uint32_t>(child)].label;
+        if (len - pos < label.size() || label.compare(0, label.size(), name + pos, label.size()) != 0) {
+          return result;
+        }
+        pos += label.size();
+        current = static_cast<uint32_t>(child);
+      }
+    }
+
+   private:
+    struct node {
+      string_t label;  // the edge from the parent
+      vector_t<uint32_t> children;
+      int32_t key;
+      int32_t prefix;
+    };
 
-    const auto opt_val = static_cast<int32_t>((short_name == '\0') ? opt_val_++ : short_name);
-    auto operator_f = convert_operator_f(std::forward<T>(f));
-    if (!operators_.emplace(opt_val, operator_option{short_name, long_name, operator_f, help, type}).second) {
-      fprintf(stderr, "duplicate option -%c, --%s\n", short_name, long_name.c_str());
+    int32_t find_child_(uint32_t parent, char ch) const {
+      for (const auto child : nodes_[parent].children) {
+        if (nodes_[child].label[0] == ch) {
+          return static_cast<int32_t>(child);
+        }
+      }
+      return -1;
     }
+
+    vector_t<node> nodes_;  // nodes_[0] is the root
+  };
+
+  // an option of this parser or of one of its parents
+  struct option_ref {
+    TinyCmdline *owner;  // nullptr if not found
+    int32_t key;         // key in owner->operators_ or index in owner->prefixes_
+  };
+
+  // result of a long name lookup through the parsers
+  struct long_match {
+    option_ref option;  // the option with this exact name
+    option_ref prefix;  // the longest prefix handler covering the name
+  };
+
+  // an argument of a preset, resolved to its option when the preset is added
+  struct preset_value {
+    option_ref ref;     // the option, or the prefix handler if is_prefix
+    bool is_prefix;
+    bool has_value;
+    string_t name;      // long name for a prefix handler
+    string_t value;
+  };
+
+  // the presets selected by the values of one option, e.g. --profile=low-latency
+  struct preset_option {
+    preset_option(string_ref name, memory_resource *resource)
+        : long_name(name.data(), name.size(), resource), presets(resource) {}
+
+    string_t long_name;
+    vector_t<std::pair<string_t, vector_t<preset_value>>> presets;  // value to resolved arguments
+  };
+
+  // what an overlay needs to hold its own value of a handle, see Overlay
+  struct handle_type {
+    size_t size;
+    size_t align;
+    bool (*convert)(const void *target, const char *optarg, void *value);  // as the option assigns, into value
+    void (*construct)(void *value);
+    void (*copy)(void *value, const void *from);  // copy-constructs value
+    void (*destroy)(void *value);
+  };
+
+  // an option dispatched by a scan of argv, the value and the name of a prefix handler view the tokens
+  struct argv_dispatch {
+    option_ref ref;
+    bool is_prefix;
+    const char *value;  // nullptr if none
+    const char *name;
+    size_t name_size;
+  };
+
+  // state of the token scanner, used for argv and by the streaming parsers
+  struct scan_state {
+    option_ref pending{nullptr, -1};         // option waiting for its required value
+    option_ref pending_prefix{nullptr, -1};  // prefix handler waiting for its required value
+    const char *prefix_name{nullptr};        // long name for the pending prefix handler, in its token
+    size_t prefix_size{0};
+    char prefix_copy[256];                   // the long name when its token is transient, prefix_name is nullptr
+    bool terminated{false};                  // "--" has been seen, the remaining tokens are positional
+    vector_t<preset_value> *preset{nullptr};  // records the options instead of dispatching them if set
+    Overlay *overlay{nullptr};                // sets the options in the overlay instead of dispatching them if set
+    vector_t<argv_dispatch> *recorded{nullptr};  // also records the dispatched options if set, see set_parse_cache()
+    bool from_argv{false};                    // the values outlive the scan and long names may be abbreviated
+    // the hooks of the uses above, set along with them so a plain parse does not link their code
+    Error (*divert)(scan_state &state, const argv_dispatch &dispatch){nullptr};  // takes the options if set
+    void (*record)(scan_state &state, const argv_dispatch &dispatch){nullptr};   // sees the dispatched options
+    const char *(*keep)(TinyCmdline &owner, const char *value){nullptr};         // copies a transient bulk value
+    parse_result result{Error::none, {}};    // the first error, the remaining tokens are ignored after it
+
+    string_ref pending_name() const { return string_ref(prefix_name ? prefix_name : prefix_copy, prefix_size); }
+  };
+
+  enum class constraint_kind { required, exclusive, implies };
+
+  // a constraint over option slots, checked a word at a time against scan_bits_
+  struct constraint {
+    constraint_kind kind;
+    int32_t trigger;               // slot of the implying option, -1 for the other kinds
+    vector_t<uint64_t> mask;       // slots of the options
+    vector_t<uint32_t> slots;      // the same slots, to name the violations
+    vector_t<string_t> names;      // the options as declared, parallel to slots, then the implying option
+  };
+
+  // where a recorded string lies in argv, the index of its token in the original argv and the offset in the token
+  struct argv_position {
+    int32_t token;  // -1 if none
+    uint32_t offset;
+  };
+
+  // an option of a memoized parse, replayed with pointers into the argv of the replay
+  struct cached_dispatch {
+    option_ref ref;
+    bool is_prefix;
+    argv_position value;
+    argv_position name;  // of the long name for a prefix handler
+    uint32_t name_size;
+  };
+
+  // a memoized parse, see set_parse_cache()
+  struct cache_entry {
+    uint64_t fingerprint;
+    string_t tokens;                       // the tokens after the program name, each with its NUL, to rule out collisions
+    vector_t<cached_dispatch> dispatches;  // the options in dispatch order
+    vector_t<int32_t> order;               // argv as the scan permuted it, by index in the original argv
+    int32_t optind;
+    uint32_t newer;                        // recency list, no_entry at the ends
+    uint32_t older;
+  };
+
+  static constexpr uint32_t no_entry = UINT32_MAX;
+
+  // the memoized parses, created in the arena by set_parse_cache(), so a parser without a cache does not link its code
+  struct parse_cache {
+    explicit parse_cache(memory_resource *resource) : entries(resource), index(resource) {}
+
+    size_t capacity{0};
+    uint64_t schema{0};               // schema_version() of the cached parses
+    vector_t<cache_entry> entries;
+    map_t<uint64_t, uint32_t> index;  // fingerprint to the index in entries
+    uint32_t newest{no_entry};
+    uint32_t oldest{no_entry};
+  };
+
+  enum class operator_kind { value, nullary, stream, bulk };
+  template <operator_kind Kind> using operator_kind_t = std::integral_constant<operator_kind, Kind>;
+
+  template <typename T>
+  static void bind_operator_f(operator_option &option, T &&f, operator_kind_t<operator_kind::value>) {
+    option.op = operator_t(std::forward<T>(f));
+  }
+  template <typename T>
+  static void bind_operator_f(operator_option &option, T &&f, operator_kind_t<operator_kind::nullary>) {
+    option.op = operator_t::dropping_arguments(std::forward<T>(f));
+  }
+  template <typename T>
+  static void bind_operator_f(operator_option &option, T &&f, operator_kind_t<operator_kind::stream>) {
+    option.stream = stream_operator_t(std::forward<T>(f));
+  }
+  template <typename T>
+  static void bind_operator_f(operator_option &option, T &&f, operator_kind_t<operator_kind::bulk>) {
+    option.bulk = bulk_operator_t(std::forward<T>(f));
   }
 
+ public:
+  static constexpr size_t stream_chunk_size = 4096;  // bytes read at once by parse_fd()
+
+  TinyCmdline() = default;
+
   /**
-   * Adds an argument to the command line parser.
+   * Creates a parser allocating from a memory resource, e.g. a monotonic_resource released at the end of a request,
+   * so registration and parsing never reach the global heap. The names and help texts are taken as string_ref and
+   * copied into the resource, so a long literal builds no temporary std::string, and a registered check is copied
+   * into it along with its compiled pattern. Only the errors, the help, handlers capturing more than a few pointers
+   * and checks built without a resource, see check(memory_resource *), use the global heap. The resource must
+   * outlive the parser.
    *
-   * @param long_name The long name of the argument.
-   * @param short_name The short name of the argument.
-   * @param value The value to be set by the argument.
-   * @param help The help text for the argument (default: "").
+   * @param resource The resource of all the containers of the parser.
    */
-  template <typename T>
-  void add_argument(const std::string &long_name, char short_name, T &value, const std::string &help = "") {
-    auto operator_f = [&value](const char *optarg) { value = convert<T>::to(optarg); };
-    add_argument(long_name, short_name, operator_f, Argument::required, help);
-  }
+  explicit TinyCmdline(memory_resource *resource)
+      : resource_(resource),
+        operators_(resource),
+        long_names_(resource),
+        prefixes_(resource),
+        presets_(resource),
+        bulk_keys_(resource),
+        bulk_strings_(resource),
+        values_(resource),
+        handle_types_(resource),
+        set_bits_(resource),
+        scan_bits_(resource),
+        constraints_(resource),
+        arena_(resource) {}
 
   /**
-   * Adds an argument to the command line parser.
+   * Creates a parser inheriting the options of a parent, e.g. a subcommand sharing the global options. Only the
+   * options added to this parser are stored, the others are looked up in the parent, and an option added here
+   * hides the parent option with the same short or long name. Inherited options dispatch to the parent, so their
+   * handles and bulk handlers are the parent ones. The parent must outlive this parser and must not get new options
+   * once it has children. The parser allocates from the resource of the parent.
    *
-   * @param long_name The long name of the argument.
-   * @param short_name The short name of the argument.
-   * @param value The value to be set by the argument.
-   * @param default_val The default value to be set if the argument is not present.
-   * @param placed_val The value to be set if the argument is present.
-   * @param help The help text for the argument (default: "").
+   * @param parent The parser holding the shared options.
    */
-  template <typename T, typename U>
-  void add_argument(const std::string &long_name, char short_name, T &value, const U &default_val, const U &placed_val,
-                    const std::string &help = "") {
-    value = static_cast<T>(default_val);
-    auto operator_f = [&value, placed_val]([[maybe_unused]] const char *) { value = static_cast<T>(placed_val); };
-    add_argument(long_name, short_name, operator_f, Argument::none, help);
+  explicit TinyCmdline(TinyCmdline *parent) : TinyCmdline(parent->resource_) {
+    opt_val_ = parent->opt_val_;
+    parent_ = parent;
   }
 
- private:
   /**
-   * Prints the usage information, automatically generated from the added arguments.
+   * A parser is move-only. The values of its handles and the targets of its options live in its own arena, so a copy
+   * could not share them. Move a parser before taking handles, since they point to it. A moved-from parser may only
+   * be destroyed or assigned to.
    */
-  void usage_() {
-    for (const auto &option_it : operators_) {
-      const auto &option = option_it.second;
-      const char *arg_str = (option.type == Argument::required) ? " <arg> " : " ";
-      if (option.short_name == '\0') {
-        fprintf(stdout, "\t--%s%s%s\n", option.long_name.c_str(), arg_str, option.help.c_str());
-      } else if (option.long_name.empty()) {
-        fprintf(stdout, "\t-%c%s%s\n", option.short_name, arg_str, option.help.c_str());
-      } else {
-        fprintf(stdout, "\t-%c, --%s%s%s\n", option.short_name, option.long_name.c_str(), arg_str, option.help.c_str());
-      }
-    }
-  }
+  TinyCmdline(const TinyCmdline &) = delete;
+  TinyCmdline &operator=(const TinyCmdline &) = delete;
+  TinyCmdline(TinyCmdline &&) = default;
+  TinyCmdline &operator=(TinyCmdline &&) = default;
 
- private:
-  int32_t opt_val_{static_cast<int32_t>(256)};  // std::numeric_limits<uint8_t>::max() + 1
-  std::unordered_map<int32_t, operator_option> operators_;
-};
+  /**
+   * Lightweight typed handle to a value owned by the parser, returned by add_argument<T>(long_name, short_name, help).
+   * Reading the value is an indexed load and checking whether the argument was set is a bit test. The parser must
+   * outlive its handles and must not be moved once they are taken.
+   *
+   * @tparam T The type of the value.
+   */
+  template <typename T> class Opt {
+   public:
+    Opt() = default;
 
-}  // namespace tiny_cmdline
+    const T &get() const { return *static_cast<const T *>(owner_->values_[slot_]); }
+    bool was_set() const { return owner_->was_set_(slot_); }
+    bool valid() const { return owner_ != nullptr; }  // false if the registration failed
+
+   private:
+    friend class TinyCmdline;
+    friend class Overlay;
+    friend class Snapshot;
+    Opt(const TinyCmdline *owner, uint32_t slot) : owner_(owner), slot_(slot) {}
+
+    const TinyCmdline *owner_{nullptr};
+    uint32_t slot_{0};
+  };
+
+  template <typename T> const T &operator[](const Opt<T> &opt) const { return opt.get(); }
+
+  /**
+   * Describes one field of a struct bound with bind(), usually written with TINY_CMDLINE_FIELD.
+   */
+  struct field {
+    const char *long_name;
+    char short_name;
+    size_t offset;                         // offset of the member in the struct
+    bool (*assign)(void *, const char *);  // converts the value into the member, shared by the fields of a type
+    const char *help;
+  };
+
+  /**
+   * Converts the argument value into the member at dst, the converter of a field of type T.
+   */
+  template <typename T> static bool assign_field(void *dst, const char *optarg) {
+    return convert_value(optarg, *static_cast<T *>(dst));
+  }
+
+  /**
+   * Hashes an option name, FNV-1a mixed with a seed. The schema generator searches the seed that makes the hash
+   * perfect over the long names of a schema.
+   */
+  static uint32_t hash_name(const char *name, size_t len, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < len; ++i) {
+      hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+    }
+    return hash;
+  }
+
+  /**
+   * Static option tables generated by tiny_cmdline_gen from a schema file, parsed without any registration.
+   */
+  struct static_schema {
+    const field *fields;          // typed binding table
+    size_t field_count;
+    const int32_t *short_fields;  // 256 entries, short name to field index, -1 if unused
+    const int32_t *long_hash;     // perfect hash of the long names to field indices, -1 for empty buckets
+    uint32_t long_hash_mask;      // size of long_hash minus 1, a power of 2 minus 1
+    uint32_t long_hash_seed;
+    const char *help;             // prebuilt usage text
+
+    /**
+     * Finds the index of a field by long name in O(1), returns -1 if not found.
+     */
+    int32_t find(const char *name, size_t len) const {
+      const int32_t index = long_hash[hash_name(name, len, long_hash_seed) & long_hash_mask];
+      if (index < 0) {
+        return -1;
+      }
+      const char *long_name = fields[index].long_name;
+      return (strncmp(long_name, name, len) == 0 && long_name[len] == '\0') ? index : -1;
+    }
+  };
+
+#ifdef TINY_CMDLINE_NO_EXCEPTIONS
+  static constexpr bool throwing_conversions = false;  // convert<T>::to() returns T{} for a value that fails
+#else
+  static constexpr bool throwing_conversions = true;  // convert<T>::to() throws for a value that fails
+#endif
+
+  /**
+   * Converts the argument value to the desired type. Specializations can be added for custom types.
+   *
+   * @tparam T The desired type.
+   */
+  template <typename T> struct convert {
+    // the throwing and the non-throwing to() are different functions, so translation units built with and without
+    // exceptions can be linked together, each calling its own
+    template <bool Throws = throwing_conversions> static T to(const char *optarg) {
+      return to_(optarg, std::integral_constant<bool, Throws>(), parsing_t());
+    }
+
+    // the error code version of to(), the whole value must be a number in the range of T
+    static bool try_to(const char *optarg, T &value) {
+      return optarg != nullptr && try_to_(optarg, value, parsing_t());
+    }
+
+   private:
+    // how T is read: strtoll, strtoull for the unsigned integers, or strtold for the floating point types
+    template <int Kind> using parsing = std::integral_constant<int, Kind>;
+    using parsing_t = parsing<std::is_floating_point<T>::value ? 2 : std::is_unsigned<T>::value ? 1 : 0>;
+
+    template <int Kind> static T to_(const char *optarg, std::false_type, parsing<Kind>) {
+      T value{};
+      try_to(optarg, value);
+      return value;
+    }
+
+#ifndef TINY_CMDLINE_NO_EXCEPTIONS
+    // std::stoll only checks the range of long long, a narrower T is checked here like try_to() does
+    static T to_(const char *optarg, std::true_type, parsing<0>) {
+      const long long parsed = std::stoll(optarg);
+      if (std::is_integral<T>::value && (parsed < static_cast<long long>(std::numeric_limits<T>::min()) ||
+                                         parsed > static_cast<long long>(std::numeric_limits<T>::max()))) {
+        throw std::out_of_range(optarg);
+      }
+      return static_cast<T>(parsed);
+    }
+
+    static T to_(const char *optarg, std::true_type, parsing<1>) {
+      if (optarg[strspn(optarg, " \t\n\v\f\r")] == '-') {
+        throw std::out_of_range(optarg);
+      }
+      const unsigned long long parsed = std::stoull(optarg);
+      if (parsed > static_cast<unsigned long long>(std::numeric_limits<T>::max())) {
+        throw std::out_of_range(optarg);
+      }
+      return static_cast<T>(parsed);
+    }
+
+    static T to_(const char *optarg, std::true_type, parsing<2>) {
+      const long double parsed = std::stold(optarg);
+      if (!in_range_(parsed)) {
+        throw std::out_of_range(optarg);
+      }
+      return static_cast<T>(parsed);
+    }
+#endif
+
+    static bool try_to_(const char *optarg, T &value, parsing<0>) {
+      char *end = nullptr;
+      errno = 0;
+      const long long parsed = strtoll(optarg, &end, 10);
+      if (end == optarg || *end != '\0' || errno == ERANGE) {
+        return false;
+      }
+      const auto converted = static_cast<T>(parsed);
+      if (std::is_integral<T>::value && static_cast<long long>(converted) != parsed) {
+        return false;
+      }
+      value = converted;
+      return true;
+    }
+
+    // strtoull negates a leading '-' instead of rejecting it, so it is checked after the whitespace strtoull skips
+    static bool try_to_(const char *optarg, T &value, parsing<1>) {
+      const char *digits = optarg + strspn(optarg, " \t\n\v\f\r");
+      if (*digits == '-') {
+        return false;
+      }
+      char *end = nullptr;
+      errno = 0;
+      const unsigned long long parsed = strtoull(digits, &end, 10);
+      if (end == digits || *end != '\0' || errno == ERANGE ||
+          parsed > static_cast<unsigned long long>(std::numeric_limits<T>::max())) {
+        return false;
+      }
+      value = static_cast<T>(parsed);
+      return true;
+    }
+
+    // decimal, hexadecimal, "inf" and "nan" as strtold reads them
+    static bool try_to_(const char *optarg, T &value, parsing<2>) {
+      char *end = nullptr;
+      errno = 0;
+      const long double parsed = strtold(optarg, &end);
+      if (end == optarg || *end != '\0' || errno == ERANGE || !in_range_(parsed)) {
+        return false;
+      }
+      value = static_cast<T>(parsed);
+      return true;
+    }
+
+    // a finite value beyond the largest T would be undefined behaviour to convert, infinities and NaN are kept
+    static bool in_range_(long double parsed) {
+      const long double limit = std::numeric_limits<T>::max();
+      const long double infinity = std::numeric_limits<long double>::infinity();
+      return !(parsed > limit || parsed < -limit) || parsed == infinity || parsed == -infinity;
+    }
+  };
+
+  /**
+   * Converts the argument value with convert<T>::try_to, or with convert<T>::to for specializations without it.
+   *
+   * @return false if the conversion failed.
+   */
+  template <typename T> static bool convert_value(const char *optarg, T &value) {
+    return convert_value_(optarg, value, 0);
+  }
+
+  /**
+   * Reads the value of --name in a literal argument string, at compile time in a constant expression, e.g. for the
+   * default command line of a deployment profile:
+   *   constexpr char profile[] = "--port=8080 --workers 16";
+   *   constexpr Config defaults{TinyCmdline::literal_value<int32_t>(profile, "port", 80), ...};
+   * The defaults are then constant-initialized in read-only data, and only the real argv is parsed on top of a copy.
+   * "--name=value" and "--name value" are read and the last one wins. The value must be a decimal integer in the
+   * range of T, otherwise the constant expression does not compile, and a run time call exits.
+   *
+   * @param args The arguments, separated by whitespace.
+   * @param name The long name of the option.
+   * @param fallback The value if the option is absent.
+   */
+  template <typename T> static constexpr T literal_value(const char *args, const char *name, T fallback) {
+    return literal_value_<T>(literal_find_(literal_skip_space_(args), name, nullptr), name, fallback);
+  }
+
+  /**
+   * Checks whether the flag --name is in a literal argument string, see literal_value().
+   */
+  static constexpr bool literal_flag(const char *args, const char *name) {
+    return literal_find_(literal_skip_space_(args), name, nullptr) != nullptr;
+  }
+
+  /**
+   * Checks every long option of a literal argument string is one of the names, e.g. the long_names of a generated
+   * schema, to reject a mistyped profile with a static_assert.
+   */
+  template <size_t N> static constexpr bool literal_known(const char *args, const char *const (&names)[N]) {
+    return literal_known_(literal_skip_space_(args), names, N);
+  }
+
+  /**
+   * Regular expression compiled once into a DFA, matched against a whole value with one table lookup per byte.
+   * Supports literals, ".", classes such as "[a-z_]" and "[^0-9]", the escapes \d \w \s \D \W \S and escaped
+   * metacharacters, groups, "|", "*", "+", "?" and the bounds "{m}", "{m,}" and "{m,n}". There are no anchors, the
+   * whole value must match.
+   */
+  class pattern {
+   public:
+    static constexpr size_t max_states = 4096;  // of the DFA, a larger expression is rejected
+    static constexpr uint32_t max_bound = 255;  // of "{m,n}"
+
+    pattern() = default;
+
+    /**
+     * Compiles the expression, the table and the temporaries of the compilation are allocated from the resource. An
+     * invalid or too large one is reported on stderr and matches nothing.
+     */
+    explicit pattern(const char *expression, memory_resource *resource = default_resource());
+
+    /**
+     * Copies a compiled pattern into another resource.
+     */
+    pattern(const pattern &other, memory_resource *resource)
+        : table_(other.table_, resource),
+          accepting_(other.accepting_, resource),
+          class_count_(other.class_count_),
+          start_(other.start_) {
+      memcpy(classes_, other.classes_, sizeof(classes_));
+    }
+
+    bool valid() const { return start_ >= 0; }
+    size_t states() const { return accepting_.size(); }
+
+    bool matches(const char *value) const {
+      int32_t state = start_;
+      for (const char *p = value; state >= 0 && *p != '\0'; ++p) {
+        state = table_[static_cast<size_t>(state) * class_count_ + classes_[static_cast<unsigned char>(*p)]];
+      }
+      return state >= 0 && accepting_[static_cast<size_t>(state)] != 0;
+    }
+
+   private:
+    struct compiler;
+
+    vector_t<int32_t> table_;        // state * class_count_ + class to the next state, -1 for no match
+    vector_t<uint8_t> accepting_;
+    uint8_t classes_[256]{};         // byte to its class, the bytes no part of the expression tells apart
+    size_t class_count_{0};
+    int32_t start_{-1};
+  };
+
+  /**
+   * Declarative validation of a typed value, run on the converted value before it is stored, so the value is
+   * parsed once and a rejected value fails the parse with Error::bad_value, e.g.
+   * add_argument("val", 0, args.val, TinyCmdline::check<int8_t>().range(0, 100), "The value to be set.");
+   *
+   * @tparam T The type of the value.
+   */
+  template <typename T> class check {
+   public:
+    check() = default;
+
+    /**
+     * Creates a check allocating the listed values and the compiled pattern from a resource, e.g. the one of the
+     * parser, so building it does not reach the global heap.
+     */
+    explicit check(memory_resource *resource) : values_(resource), expression_(resource) {}
+
+    /**
+     * Copies a check into another resource, as the parser does when the check is registered.
+     */
+    check(const check &other, memory_resource *resource)
+        : min_(other.min_),
+          max_(other.max_),
+          step_(other.step_),
+          has_range_(other.has_range_),
+          has_step_(other.has_step_),
+          has_pattern_(other.has_pattern_),
+          values_(other.values_, resource),
+          expression_(other.expression_, resource),
+          pattern_(other.pattern_, resource) {}
+
+    /**
+     * Accepts the values in [min, max].
+     */
+    check &range(const T &min, const T &max) {
+      min_ = min;
+      max_ = max;
+      has_range_ = true;
+      return *this;
+    }
+
+    /**
+     * Accepts the multiples of step, counted from the minimum of the range if any, from 0 otherwise.
+     */
+    check &step(const T &step) {
+      static_assert(std::is_integral<T>::value, "A step needs an integral type.");
+      step_ = step;
+      has_step_ = true;
+      return *this;
+    }
+
+    /**
+     * Accepts the listed values only.
+     */
+    check &one_of(std::initializer_list<T> values) {
+      values_.assign(values.begin(), values.end());
+      return *this;
+    }
+
+    /**
+     * Accepts the values whose text matches a regular expression, see pattern. The text is matched before the
+     * conversion, the expression is compiled here.
+     */
+    check &matches(const char *expression) {
+      pattern_ = pattern(expression, values_.get_allocator().resource());
+      expression_.assign(expression);
+      has_pattern_ = true;
+      return *this;
+    }
+
+    bool accepts_text(const char *optarg) const {
+      return !has_pattern_ || (optarg != nullptr && pattern_.matches(optarg));
+    }
+
+    bool accepts(const T &value) const {
+      if (has_range_ && (value < min_ || max_ < value)) {
+        return false;
+      }
+      if (has_step_ && !on_step_(value, std::is_integral<T>())) {
+        return false;
+      }
+      for (const auto &allowed : values_) {
+        if (allowed == value) {
+          return true;
+        }
+      }
+      return values_.empty();
+    }
+
+    /**
+     * Describes the rule a text rejected by accepts_text() breaks, e.g. "does not match \d+".
+     */
+    std::string text_violation() const { return "does not match " + std::string(expression_.c_str()); }
+
+    /**
+     * Describes the first rule a value rejected by accepts() breaks, e.g. "not in [0, 100]", empty if it breaks none.
+     * A nullptr value stands for a text that does not convert, e.g. "not a valid value in [0, 100]".
+     */
+    std::string violation(const T *value) const {
+      if (value == nullptr) {
+        return has_range_ ? "not a valid value in " + range_() : "not a valid value";
+      }
+      std::string why;
+      if (has_range_ && (*value < min_ || max_ < *value)) {
+        return "not in " + range_();
+      }
+      if (has_step_ && !on_step_(*value, std::is_integral<T>())) {
+        why = "not a multiple of ";
+        append_(why, step_, 0);
+        if (has_range_) {
+          why += " from ";
+          append_(why, min_, 0);
+        }
+        return why;
+      }
+      if (!accepts(*value)) {
+        why = "not one of ";
+        for (const auto &allowed : values_) {
+          if (!append_(why, allowed, 0)) {
+            return "not one of the listed values";
+          }
+          why += (&allowed == &values_.back()) ? "" : ", ";
+        }
+      }
+      return why;
+    }
+
+   private:
+    std::string range_() const {
+      std::string range = "[";
+      if (!append_(range, min_, 0)) {
+        return "the range";
+      }
+      range += ", ";
+      append_(range, max_, 0);
+      return range + "]";
+    }
+
+    // prints a value of the rules, returns false if its type cannot be printed
+    template <typename U>
+    static auto append_(std::string &out, const U &value, int) -> decltype(std::to_string(value), true) {
+      out += std::to_string(value);
+      return true;
+    }
+    template <typename U> static auto append_(std::string &out, const U &value, long) -> decltype(out += value, true) {
+      out += value;
+      return true;
+    }
+    template <typename U> static bool append_(std::string &, const U &, ...) { return false; }
+
+    bool on_step_(const T &value, std::true_type) const {
+      return step_ == 0 || (value - (has_range_ ? min_ : T())) % step_ == 0;
+    }
+    bool on_step_(const T &, std::false_type) const { return true; }
+
+    T min_{};
+    T max_{};
+    T step_{};
+    bool has_range_{false};
+    bool has_step_{false};
+    bool has_pattern_{false};
+    vector_t<T> values_;
+    string_t expression_;  // of the pattern, for text_violation()
+    pattern pattern_;
+  };
+
+  /**
+   * Format of a value with a fixed number of elements in one argument, e.g. split('x') for "1920x1080".
+   */
+  struct split {
+    explicit split(char separator = ',') : separator(separator) {}
+
+    char separator;
+  };
+
+  /**
+   * Prints the help information.
+   */
+  void print_help();
+
+  /**
+   * Parses the command line arguments. Prints the help and exits on -h, --help or any error.
+   *
+   * @param argc The number of command line arguments.
+   * @param argv The command line arguments.
+   */
+  void parse(int argc, char *argv[]) { exit_on_error_(try_parse(argc, argv)); }
+
+  /**
+   * Parses the command line arguments, reporting -h, --help and errors through the result instead of exiting.
+   *
+   * @param argc The number of command line arguments.
+   * @param argv The command line arguments.
+   * @return The result, the options after an error are not dispatched.
+   */
+  parse_result try_parse(int argc, char *argv[]);
+
+  /**
+   * Sets the capacity of the cache of parse_cached() and try_parse_cached(), for a parser that sees the same command
+   * lines over and over, e.g. the admin commands of a server. Without a call they parse like parse() and
+   * try_parse(), which never use the cache, so a program that does not cache does not link it.
+   *
+   * @param capacity The maximum number of command lines kept, 0 drops the cache.
+   */
+  void set_parse_cache(size_t capacity);
+
+  /**
+   * Parses the command line arguments like parse(), through the cache set by set_parse_cache().
+   */
+  void parse_cached(int argc, char *argv[]) { exit_on_error_(try_parse_cached(argc, argv)); }
+
+  /**
+   * Parses the command line arguments like try_parse(), memoizing the successful parses. The tokens are
+   * fingerprinted and a repeated command line replays its recorded options, skipping the scan and the name lookups,
+   * then reorders argv and sets optind the way the scan did. The values are converted and the handlers called again
+   * with pointers into the replayed argv, so a replay has the effects of a parse and a handler may keep its value as
+   * long as argv lives. The least recently used command line is dropped beyond the capacity, and adding an option
+   * empties the cache.
+   *
+   * @param argc The number of command line arguments.
+   * @param argv The command line arguments.
+   * @return The result, the options after an error are not dispatched.
+   */
+  parse_result try_parse_cached(int argc, char *argv[]);
+
+  /**
+   * Deduplicates the string values copied by the parser, so a value repeated on the command line, e.g. a host name
+   * in a generated list, is stored once and the values passed to the bulk handler share the characters. It applies
+   * to the copies of the values of bulk handlers made by the streaming parsers, kept until the end of a parse. A
+   * string_ref option holds a single value in its own buffer, so it does not need it. Without it every value is
+   * copied, which is cheaper for values that rarely repeat.
+   *
+   * @param enabled Whether the values are interned.
+   */
+  void set_string_interning(bool enabled);
+
+  /**
+   * Changes whenever an option, a prefix handler or a preset is added to this parser or to its parents.
+   */
+  uint64_t schema_version() const {
+    uint64_t version = 0;
+    for (const TinyCmdline *cmd = this; cmd != nullptr; cmd = cmd->parent_) {
+      version += cmd->schema_version_;
+    }
+    return version;
+  }
+
+  /**
+   * Sets the handler of the positional arguments of parse_fd(), parse_block() and PushParser, called in order with
+   * the options. Without one a positional argument fails these parses with Error::positional. parse() leaves the
+   * positional arguments in argv after optind as getopt does, and a preset or an Overlay rejects them.
+   *
+   * @param f The handler, called with each positional argument, transient like the other streamed values.
+   */
+  void set_positional_handler(operator_t f) { positional_ = std::move(f); }
+
+  /**
+   * Parses NUL-delimited arguments from a file descriptor, the same format `xargs -0` consumes.
+   * The stream is read in fixed-size chunks and every option is dispatched as soon as its tokens are complete, so the
+   * memory used is bounded by the chunk size plus the longest single token, whatever the length of the stream.
+   * Prints the help and exits on -h, --help or any error.
+   *
+   * @param fd The file descriptor to read from, e.g. STDIN_FILENO.
+   */
+  void parse_fd(int fd) { exit_on_error_(try_parse_fd(fd)); }
+
+  /**
+   * Parses NUL-delimited arguments from a file descriptor, reporting errors through the result, see parse_fd().
+   *
+   * @param fd The file descriptor to read from, e.g. STDIN_FILENO.
+   * @return The result, the options after an error are not dispatched. Reading stops at the first error, so the
+   * rest of the stream is left unread.
+   */
+  parse_result try_parse_fd(int fd);
+
+  /**
+   * Parses NUL-delimited arguments held in memory, e.g. a mapped response file, with the conventions of parse_fd().
+   * The tokens are split with one memchr pass and dispatched in place, none is copied unless the block does not end
+   * with a NUL. Prints the help and exits on -h, --help or any error.
+   *
+   * @param data The arguments, each terminated by a NUL except possibly the last one.
+   * @param size The size of the block in bytes.
+   */
+  void parse_block(const char *data, size_t size) { exit_on_error_(try_parse_block(data, size)); }
+
+  /**
+   * Parses NUL-delimited arguments held in memory, reporting errors through the result, see parse_block().
+   *
+   * @param data The arguments, each terminated by a NUL except possibly the last one.
+   * @param size The size of the block in bytes.
+   * @return The result, the options after an error are not dispatched.
+   */
+  parse_result try_parse_block(const char *data, size_t size);
+
+  /**
+   * Push-style parser for input that is still arriving, e.g. an interactive console or a line-oriented protocol.
+   * Tokens or raw bytes are fed one at a time and every option fires as soon as it and its value are complete.
+   * The state is the scanner state and a fixed-size token buffer, feeding never allocates.
+   *
+   * @tparam TokenSize The maximum length of a token fed as raw bytes.
+   */
+  template <size_t TokenSize = stream_chunk_size> class PushParser {
+   public:
+    /**
+     * @param cmd The parser holding the options, it must outlive the push parser.
+     * @param delimiters The extra characters splitting raw bytes into tokens, '\0' always splits. Consecutive
+     * delimiters are collapsed when there are extra ones, e.g. " \t\n" for whitespace separated words.
+     */
+    explicit PushParser(TinyCmdline &cmd, const char *delimiters = "") : cmd_(cmd), delimiters_(delimiters) {
+      state_.keep = &keep_transient_;
+      cmd_.begin_scan_();
+    }
+
+    /**
+     * Feeds one complete token.
+     */
+    void feed(const char *token) { cmd_.scan_token_(state_, token); }
+
+    /**
+     * Feeds raw bytes, tokens are completed at the delimiters and may span several calls.
+     * Tokens longer than TokenSize - 1 fail with Error::too_long.
+     */
+    void feed(const char *data, size_t size) {
+      for (size_t i = 0; i < size; ++i) {
+        const char ch = data[i];
+        if (ch == '\0' || strchr(delimiters_, ch) != nullptr) {
+          if (ch == '\0' || length_ > 0) {
+            buffer_[length_] = '\0';
+            cmd_.scan_token_(state_, buffer_, length_);
+            length_ = 0;
+          }
+          continue;
+        }
+        if (length_ + 1 >= TokenSize) {
+          cmd_.scan_fail_(state_, Error::too_long, std::string(buffer_, length_));
+          length_ = 0;
+          continue;
+        }
+        buffer_[length_++] = ch;
+      }
+    }
+
+    /**
+     * Ends the input, feeding the last unterminated token and checking no value is missing. The parser is reset
+     * and can be used for the next input, e.g. the next command of a console. Errors are reported through the
+     * result, a push parser never exits.
+     *
+     * @return The result of the input, the options after an error are not dispatched.
+     */
+    parse_result finish() {
+      if (length_ > 0) {
+        buffer_[length_] = '\0';
+        cmd_.scan_token_(state_, buffer_, length_);
+        length_ = 0;
+      }
+      cmd_.scan_finish_(state_);
+      cmd_.end_scan_(state_.result);
+      parse_result result = std::move(state_.result);
+      state_ = scan_state();
+      state_.keep = &keep_transient_;  // the reset clears the hooks, and buffer_ is reused by the next command
+      return result;
+    }
+
+   private:
+    TinyCmdline &cmd_;
+    const char *delimiters_;
+    scan_state state_;
+    size_t length_{0};
+    char buffer_[TokenSize];
+  };
+
+  /**
+   * Adds an argument to the command line parser.
+   *
+   * @param long_name The long name of the argument.
+   * @param short_name The short name of the argument.
+   * @param f The operator function associated with the argument, which takes the argument value as a parameter.
+   * A stream operator taking (chunk, size) receives the value in chunks instead, see stream_value_().
+   * A bulk operator taking (values, count) is called once after scanning with all the values of the argument, in
+   * the order they appear, instead of once per occurrence.
+   * @param type The type of the argument (default: Argument::Required).
+   * @param help The help text for the argument (default: "").
+   */
+  template <typename T>
+  void add_argument(string_ref long_name, char short_name, T &&f, Argument type, string_ref help = "") {
+    using decay_f = typename std::decay<T>::type;
+    constexpr bool is_operator_f = std::is_convertible<decay_f, operator_t>::value;
+    constexpr bool is_void_operator_f = std::is_convertible<decay_f, void_operator_t>::value;
+    constexpr bool is_stream_operator_f = std::is_convertible<decay_f, stream_operator_t>::value;
+    constexpr bool is_bulk_operator_f = std::is_convertible<decay_f, bulk_operator_t>::value;
+    static_assert(is_operator_f || is_void_operator_f || is_stream_operator_f || is_bulk_operator_f,
+                  "The operator function must be operator_t, void_operator_t, stream_operator_t or bulk_operator_t.");
+
+    operator_option option = make_option_(short_name, long_name, help, type, nullptr, nullptr);
+    constexpr operator_kind kind = is_operator_f        ? operator_kind::value
+                                   : is_void_operator_f  ? operator_kind::nullary
+                                   : is_stream_operator_f ? operator_kind::stream
+                                                          : operator_kind::bulk;
+    bind_operator_f(option, std::forward<T>(f), operator_kind_t<kind>());
+    add_option_(std::move(option));
+  }
+
+  /**
+   * Adds an argument to the command line parser, the value is stored by the parser.
+   *
+   * @tparam T The type of the value, converted with convert<T>, or string_ref to copy it into a buffer of the option.
+   * @param long_name The long name of the argument.
+   * @param short_name The short name of the argument.
+   * @param help The help text for the argument (default: "").
+   * @return The handle to read the value, invalid if the option is a duplicate.
+   */
+  template <typename T>
+  Opt<T> add_argument(string_ref long_name, char short_name, string_ref help = "") {
+    T *value = arena_.create<T>();
+    const owned_value owned = owned_(value);
+    const int32_t slot = add_option_(
+        make_option_(short_name, long_name, help, Argument::required, owned.assign, owned.target));
+    if (slot < 0) {
+      return Opt<T>();
+    }
+    values_[slot] = value;
+    handle_types_[slot] = owned.type;
+    return Opt<T>(this, static_cast<uint32_t>(slot));
+  }
+
+  /**
+   * Adds an argument to the command line parser, the value is stored by the parser once it passes the check.
+   *
+   * @tparam T The type of the value, converted with convert<T>.
+   * @param long_name The long name of the argument.
+   * @param short_name The short name of the argument.
+   * @param rules The check of the converted value.
+   * @param help The help text for the argument (default: "").
+   * @return The handle to read the value, invalid if the option is a duplicate.
+   */
+  template <typename T>
+  Opt<T> add_argument(string_ref long_name, char short_name, const check<T> &rules,
+                      string_ref help = "") {
+    T *value = arena_.create<T>();
+    auto option = make_option_(short_name, long_name, help, Argument::required, &assign_checked_<T>,
+                               checked_(*value, rules));
+    option.explain = &explain_checked_<T>;
+    const int32_t slot = add_option_(std::move(option));
+    if (slot < 0) {
+      return Opt<T>();
+    }
+    values_[slot] = value;
+    handle_types_[slot] = handle_type_of_<T, &convert_checked_<T>>();
+    return Opt<T>(this, static_cast<uint32_t>(slot));
+  }
+
+  /**
+   * Adds an argument to the command line parser.
+   *
+   * @param long_name The long name of the argument.
+   * @param short_name The short name of the argument.
+   * @param value The value to be set by the argument.
+   * @param help The help text for the argument (default: "").
+   */
+  template <typename T>
+  void add_argument(string_ref long_name, char short_name, T &value, string_ref help = "") {
+    add_option_(
+        make_option_(short_name, long_name, help, Argument::required, &assign_field<T>, &value));
+  }
+
+  /**
+   * Adds an argument whose value is copied into a buffer of the option instead of a std::string, the buffer only
+   * grows when a longer value is set, so a parser reused for many parses does not accumulate the values.
+   *
+   * @param long_name The long name of the argument.
+   * @param short_name The short name of the argument.
+   * @param value The view to be set by the argument, valid until the option is set again.
+   * @param help The help text for the argument (default: "").
+   */
+  void add_argument(string_ref long_name, char short_name, string_ref &value, string_ref help = "") {
+    add_option_(make_option_(short_name, long_name, help, Argument::required, &assign_buffered_,
+                             buffered_(value)));
+  }
+
+  /**
+   * Adds an argument to the command line parser, the value is only set if it passes the check.
+   *
+   * @param long_name The long name of the argument.
+   * @param short_name The short name of the argument.
+   * @param value The value to be set by the argument.
+   * @param rules The check of the converted value.
+   * @param help The help text for the argument (default: "").
+   */
+  template <typename T>
+  void add_argument(string_ref long_name, char short_name, T &value, const check<T> &rules,
+                    string_ref help = "") {
+    auto option = make_option_(short_name, long_name, help, Argument::required, &assign_checked_<T>,
+                               checked_(value, rules));
+    option.explain = &explain_checked_<T>;
+    add_option_(std::move(option));
+  }
+
+  /**
+   * Adds an argument whose value has a fixed number of elements split by a separator, e.g. "--window 1920x1080"
+   * into a std::pair<int, int> or "--point 1,2,3" into a std::array<double, 3>. The number of elements is the
+   * std::tuple_size of the value and each element is converted in place with its convert<T>. The value is only set
+   * if the number of elements matches and all of them convert.
+   *
+   * @param long_name The long name of the argument.
+   * @param short_name The short name of the argument.
+   * @param value The value to be set by the argument, a std::array, std::pair or std::tuple.
+   * @param format The separator of the elements.
+   * @param help The help text for the argument (default: "").
+   */
+  template <typename T>
+  void add_argument(string_ref long_name, char short_name, T &value, split format,
+                    string_ref help = "") {
+    add_option_(make_option_(short_name, long_name, help, Argument::required, &assign_split_<T>,
+                             split_(value, format)));
+  }
+
+  /**
+   * Adds an argument with a fixed number of elements, the value is stored by the parser, see the overload above.
+   *
+   * @tparam T The type of the value, a std::array, std::pair or std::tuple.
+   * @return The handle to read the value, invalid if the option is a duplicate.
+   */
+  template <typename T>
+  Opt<T> add_argument(string_ref long_name, char short_name, split format, string_ref help = "") {
+    T *value = arena_.create<T>();
+    const int32_t slot = add_option_(make_option_(short_name, long_name, help, Argument::required,
+                                                  &assign_split_<T>, split_(*value, format)));
+    if (slot < 0) {
+      return Opt<T>();
+    }
+    values_[slot] = value;
+    handle_types_[slot] = handle_type_of_<T, &convert_split_<T>>();
+    return Opt<T>(this, static_cast<uint32_t>(slot));
+  }
+
+  /**
+   * Adds an argument to the command line parser.
+   *
+   * @param long_name The long name of the argument.
+   * @param short_name The short name of the argument.
+   * @param value The value to be set by the argument.
+   * @param default_val The default value to be set if the argument is not present.
+   * @param placed_val The value to be set if the argument is present.
+   * @param help The help text for the argument (default: "").
+   */
+  template <typename T, typename U>
+  void add_argument(string_ref long_name, char short_name, T &value, const U &default_val, const U &placed_val,
+                    string_ref help = "") {
+    value = static_cast<T>(default_val);
+    auto operator_f = [&value, placed_val]([[maybe_unused]] const char *) { value = static_cast<T>(placed_val); };
+    add_argument(long_name, short_name, operator_f, Argument::none, help);
+  }
+
+  /**
+   * Binds the fields of a struct in one call. Every field is dispatched through its converter and offset, no
+   * operator function is created per field.
+   *
+   * @param object The struct to be set by the arguments.
+   * @param fields The field descriptors, see TINY_CMDLINE_FIELD.
+   * @param count The number of fields.
+   */
+  template <typename S> void bind(S &object, const field *fields, size_t count) {
+    operators_.reserve(operators_.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+      const field &f = fields[i];
+      void *target = reinterpret_cast<unsigned char *>(&object) + f.offset;
+      add_option_(make_option_(f.short_name, f.long_name, f.help, Argument::required, f.assign, target));
+    }
+  }
+
+  template <typename S> void bind(S &object, std::initializer_list<field> fields) {
+    bind(object, fields.begin(), fields.size());
+  }
+
+  /**
+   * Binds the fields of a nested struct under a namespace, e.g. the fields of config.db.pool as --db.pool.<name>,
+   * so the descriptors of a struct can be reused wherever it is nested.
+   *
+   * @param prefix The namespace, prepended to the long names with a dot.
+   * @param object The nested struct to be set by the arguments.
+   * @param fields The field descriptors, see TINY_CMDLINE_FIELD.
+   * @param count The number of fields.
+   */
+  template <typename S> void bind(string_ref prefix, S &object, const field *fields, size_t count) {
+    operators_.reserve(operators_.size() + count);
+    string_t long_name(resource_);
+    for (size_t i = 0; i < count; ++i) {
+      const field &f = fields[i];
+      long_name.clear();
+      if (f.long_name[0] != '\0') {
+        long_name.append(prefix.data(), prefix.size()).append(1, '.').append(f.long_name);
+      }
+      void *target = reinterpret_cast<unsigned char *>(&object) + f.offset;
+      add_option_(make_option_(f.short_name, long_name, f.help, Argument::required, f.assign, target));
+    }
+  }
+
+  template <typename S> void bind(string_ref prefix, S &object, std::initializer_list<field> fields) {
+    bind(prefix, object, fields.begin(), fields.size());
+  }
+
+  /**
+   * Adds a handler for every option under a namespace that has no option of its own, e.g. "log" for --log.<any>.
+   * The longest matching namespace wins.
+   *
+   * @param prefix The namespace, without the trailing dot.
+   * @param f The handler, which takes the full long name and the argument value as parameters. The name views the
+   *          token, so it is only valid during the call. When a streaming parser finds the value in the next token,
+   *          the name waits in a buffer of the scanner and a name of 256 bytes or more fails with Error::too_long.
+   * @param type The type of the arguments.
+   * @param help The help text for the namespace (default: "").
+   */
+  void add_prefix_argument(string_ref prefix, prefix_operator_t f, Argument type, string_ref help = "");
+
+  /**
+   * Adds a preset, a value of an option standing for a bundle of arguments, e.g. --profile=low-latency.
+   * The arguments are tokenized and resolved to their options here, so applying the preset dispatches them directly.
+   * The option is added with the first preset, the options used by a preset must be added before it.
+   *
+   * @param long_name The long name of the option selecting the presets.
+   * @param value The value selecting this preset.
+   * @param arguments The arguments of the preset, separated by whitespace, without quoting.
+   */
+  void add_preset(string_ref long_name, string_ref value, string_ref arguments);
+
+  /**
+   * Declares options that must be given. The options are named as on the command line, "--name" or "-n", and
+   * must be options of this parser added before. Like the other constraints, it is compiled into a bitmask over the
+   * option slots and checked after the scan, against the options of that command line only, so a reused parser or
+   * a PushParser checks every command on its own. Violations fail the parse with Error::constraint, all of them
+   * reported at once.
+   *
+   * @param names The required options.
+   */
+  void add_required(std::initializer_list<string_ref> names);
+
+  /**
+   * Declares options that conflict, at most one of them may be given, e.g. {"--json", "--yaml"}.
+   *
+   * @param names The mutually exclusive options.
+   */
+  void add_exclusive(std::initializer_list<string_ref> names);
+
+  /**
+   * Declares that an option needs others, e.g. "--ip" needs {"--port"}.
+   *
+   * @param name The option.
+   * @param implied The options that must be given with it.
+   */
+  void add_implies(string_ref name, std::initializer_list<string_ref> implied);
+
+  /**
+   * Parses the command line arguments against a generated schema, skipping all runtime registration.
+   * Prints the help and exits on -h, --help or any error.
+   *
+   * @param schema The tables generated by tiny_cmdline_gen.
+   * @param object The struct described by the schema.
+   * @param argc The number of command line arguments.
+   * @param argv The command line arguments.
+   */
+  template <typename S> static void parse(const static_schema &schema, S &object, int argc, char *argv[]) {
+    const parse_result result = try_parse(schema, object, argc, argv);
+    if (!result) {
+      fputs(schema.help, stdout);
+      exit(result.error == Error::help ? 0 : 1);
+    }
+  }
+
+  /**
+   * Parses the command line arguments against a generated schema, reporting errors through the result.
+   */
+  template <typename S>
+  static parse_result try_parse(const static_schema &schema, S &object, int argc, char *argv[]) {
+    return scan_schema_(schema, reinterpret_cast<unsigned char *>(&object), argc, argv);
+  }
+
+ private:
+  // compile-time scanning of literal argument strings, one recursion per character as C++11 constexpr requires
+  static constexpr bool literal_space_(char c) { return c == ' ' || c == '\t' || c == '\n'; }
+  static constexpr bool literal_end_(char c) { return c == '\0' || literal_space_(c); }
+  static constexpr bool literal_digit_(char c) { return c >= '0' && c <= '9'; }
+  static constexpr bool literal_starts_(const char *s, const char *prefix) {
+    return *prefix == '\0' || (*s == *prefix && literal_starts_(s + 1, prefix + 1));
+  }
+  static constexpr size_t literal_length_(const char *s) { return (*s == '\0') ? 0 : 1 + literal_length_(s + 1); }
+  static constexpr const char *literal_skip_space_(const char *s) {
+    return literal_space_(*s) ? literal_skip_space_(s + 1) : s;
+  }
+  static constexpr const char *literal_skip_token_(const char *s) {
+    return literal_end_(*s) ? s : literal_skip_token_(s + 1);
+  }
+  static constexpr const char *literal_next_(const char *token) {
+    return literal_skip_space_(literal_skip_token_(token));
+  }
+
+  // whether the token is --name or --name=value
+  static constexpr bool literal_names_(const char *token, const char *name) {
+    return literal_starts_(token, "--") && literal_starts_(token + 2, name) &&
+           (token[2 + literal_length_(name)] == '=' || literal_end_(token[2 + literal_length_(name)]));
+  }
+
+  // the last token naming the option from token on, or found
+  static constexpr const char *literal_find_(const char *token, const char *name, const char *found) {
+    return (*token == '\0') ? found
+                            : literal_find_(literal_next_(token), name, literal_names_(token, name) ? token : found);
+  }
+
+  static constexpr bool literal_listed_(const char *token, const char *const *names, size_t count) {
+    return count > 0 && (literal_names_(token, *names) || literal_listed_(token, names + 1, count - 1));
+  }
+
+  static constexpr bool literal_known_(const char *token, const char *const *names, size_t count) {
+    return *token == '\0' || ((!literal_starts_(token, "--") || literal_listed_(token, names, count)) &&
+                               literal_known_(literal_next_(token), names, count));
+  }
+
+  // a value is at most 18 digits, so the accumulation never overflows
+  static constexpr size_t literal_digits_(const char *s) { return literal_digit_(*s) ? 1 + literal_digits_(s + 1) : 0; }
+  static constexpr long long literal_accumulate_(const char *s, long long value) {
+    return literal_digit_(*s) ? literal_accumulate_(s + 1, value * 10 + (*s - '0')) : value;
+  }
+
+  // not constexpr, so a bad value in a constant expression fails to compile
+  template <typename T> static T literal_error_(const char *name) {
+    fprintf(stderr, "bad literal value of --%s\n", name);
+    exit(1);
+  }
+
+  template <typename T> static constexpr T literal_fit_(long long value, const char *name) {
+    return (static_cast<long long>(static_cast<T>(value)) == value && (value >= 0 || std::is_signed<T>::value))
+               ? static_cast<T>(value)
+               : literal_error_<T>(name);
+  }
+
+  static constexpr long long literal_magnitude_(const char *value, const char *name) {
+    return (literal_digits_(value) > 0 && literal_digits_(value) <= 18 && literal_end_(value[literal_digits_(value)]))
+               ? literal_accumulate_(value, 0)
+               : literal_error_<long long>(name);
+  }
+
+  template <typename T> static constexpr T literal_signed_(const char *value, const char *name) {
+    return literal_fit_<T>((*value == '-') ? -literal_magnitude_(value + 1, name) : literal_magnitude_(value, name),
+                           name);
+  }
+
+  // the value of the token naming the option, after '=' or in the next token
+  template <typename T> static constexpr T literal_value_(const char *token, const char *name, T fallback) {
+    return (token == nullptr) ? fallback
+           : (token[2 + literal_length_(name)] == '=')
+               ? literal_signed_<T>(token + 3 + literal_length_(name), name)
+               : literal_signed_<T>(literal_next_(token), name);
+  }
+
+  template <typename T>
+  static auto convert_value_(const char *optarg, T &value, int) -> decltype(convert<T>::try_to(optarg, value)) {
+    return convert<T>::try_to(optarg, value);
+  }
+  template <typename T> static bool convert_value_(const char *optarg, T &value, long) {
+    value = convert<T>::to(optarg);
+    return true;
+  }
+
+  // target of a split value, kept in the arena
+  template <typename T> struct split_value {
+    T *target;
+    char separator;
+  };
+
+  template <typename T> split_value<T> *split_(T &target, split format) {
+    auto *value = arena_.create<split_value<T>>();
+    value->target = &target;
+    value->separator = format.separator;
+    return value;
+  }
+
+  template <size_t... I> struct index_list {};
+  template <size_t N, size_t... I> struct make_index_list : make_index_list<N - 1, N - 1, I...> {};
+  template <size_t... I> struct make_index_list<0, I...> {
+    using type = index_list<I...>;
+  };
+
+  /**
+   * Converts the elements of a split value, the target is left untouched if the count or an element is wrong.
+   */
+  template <typename T> static bool assign_split_(void *target, const char *optarg) {
+    T value{};
+    if (!convert_split_(target, optarg, value)) {
+      return false;
+    }
+    *static_cast<const split_value<T> *>(target)->target = std::move(value);
+    return true;
+  }
+
+  template <typename T> static bool convert_split_(const void *target, const char *optarg, T &value) {
+    const char separator = static_cast<const split_value<T> *>(target)->separator;
+    constexpr size_t count = std::tuple_size<T>::value;
+    if (optarg == nullptr) {
+      return false;
+    }
+    size_t elements = 1;
+    for (const char *cursor = optarg; (cursor = strchr(cursor, separator)) != nullptr && *cursor != '\0'; ++cursor) {
+      ++elements;
+    }
+    return elements == count && convert_elements_(optarg, separator, value, typename make_index_list<count>::type());
+  }
+
+  template <typename T, size_t... I>
+  static bool convert_elements_(const char *cursor, char separator, T &value, index_list<I...>) {
+    using std::get;
+    // a braced list is evaluated in order, so the elements are converted from left to right
+    const bool converted[] = {true, convert_element_(cursor, separator, get<I>(value))...};
+    for (bool element : converted) {
+      if (!element) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // converts the element up to the next separator, terminated in a stack buffer unless it is long
+  template <typename E> static bool convert_element_(const char *&cursor, char separator, E &element) {
+    const char *end = strchr(cursor, separator);
+    end = (end == nullptr) ? cursor + strlen(cursor) : end;
+    const auto size = static_cast<size_t>(end - cursor);
+    char buffer[64];
+    bool converted = false;
+    if (size < sizeof(buffer)) {
+      memcpy(buffer, cursor, size);
+      buffer[size] = '\0';
+      converted = convert_value(buffer, element);
+    } else {
+      converted = convert_value(std::string(cursor, size).c_str(), element);
+    }
+    cursor = (*end == '\0') ? end : end + 1;
+    return converted;
+  }
+
+  // target of a string_ref value, kept in the arena, its buffer is overwritten by the next value that fits
+  struct buffered_value {
+    string_ref *target{nullptr};
+    memory_resource *resource{nullptr};
+    char *data{nullptr};
+    size_t capacity{0};
+    ~buffered_value() {
+      if (data != nullptr) {
+        resource->deallocate(data, capacity, 1);
+      }
+    }
+  };
+
+  buffered_value *buffered_(string_ref &target) {
+    auto *buffered = arena_.create<buffered_value>();
+    buffered->target = &target;
+    buffered->resource = resource_;
+    return buffered;
+  }
+
+  static bool assign_buffered_(void *target, const char *optarg) {
+    if (optarg == nullptr) {
+      return false;
+    }
+    auto *buffered = static_cast<buffered_value *>(target);
+    const size_t size = strlen(optarg);
+    if (size >= buffered->capacity) {
+      const size_t capacity = (size + 1 > buffered->capacity * 2) ? size + 1 : buffered->capacity * 2;
+      char *data = static_cast<char *>(buffered->resource->allocate(capacity, 1));
+      if (buffered->data != nullptr) {
+        buffered->resource->deallocate(buffered->data, buffered->capacity, 1);
+      }
+      buffered->data = data;
+      buffered->capacity = capacity;
+    }
+    memcpy(buffered->data, optarg, size + 1);
+    *buffered->target = string_ref(buffered->data, size);
+    return true;
+  }
+
+  // an Overlay must not write to the buffers of its parser, its string_ref values view the tokens
+  static bool convert_viewed_(const void *, const char *optarg, string_ref &value) {
+    if (optarg == nullptr) {
+      return false;
+    }
+    value = string_ref(optarg, strlen(optarg));
+    return true;
+  }
+
+  // how a value owned by the parser is assigned, see add_argument<T>(long_name, short_name, help)
+  struct owned_value {
+    bool (*assign)(void *, const char *);
+    void *target;
+    const handle_type *type;
+  };
+
+  template <typename T> owned_value owned_(T *value) {
+    return owned_value{&assign_field<T>, value, handle_type_of_<T, &convert_plain_<T>>()};
+  }
+  owned_value owned_(string_ref *value) {
+    return owned_value{&assign_buffered_, buffered_(*value), handle_type_of_<string_ref, &convert_viewed_>()};
+  }
+
+  // target of a checked value, kept in the arena along with a copy of the check in the resource of the parser
+  template <typename T> struct checked_value {
+    checked_value(T *target, const check<T> &rules, memory_resource *resource)
+        : target(target), rules(rules, resource) {}
+
+    T *target;
+    check<T> rules;
+  };
+
+  template <typename T> checked_value<T> *checked_(T &target, const check<T> &rules) {
+    return arena_.create<checked_value<T>>(&target, rules, resource_);
+  }
+
+  /**
+   * Matches, converts and checks the argument value in one pass, the target is left untouched if any step fails.
+   */
+  template <typename T> static bool assign_checked_(void *dst, const char *optarg) {
+    T value{};
+    if (!convert_checked_(dst, optarg, value)) {
+      return false;
+    }
+    *static_cast<checked_value<T> *>(dst)->target = std::move(value);
+    return true;
+  }
+
+  template <typename T> static bool convert_checked_(const void *dst, const char *optarg, T &value) {
+    const auto &rules = static_cast<const checked_value<T> *>(dst)->rules;
+    return rules.accepts_text(optarg) && convert_value(optarg, value) && rules.accepts(value);
+  }
+
+  // names the rule a value rejected by assign_checked_() breaks
+  template <typename T> static void explain_checked_(const void *dst, const char *optarg, std::string &why) {
+    const auto &rules = static_cast<const checked_value<T> *>(dst)->rules;
+    T value{};
+    if (!rules.accepts_text(optarg)) {
+      why = rules.text_violation();
+    } else {
+      why = rules.violation(convert_value(optarg, value) ? &value : nullptr);
+    }
+  }
+
+  template <typename T> static bool convert_plain_(const void *, const char *optarg, T &value) {
+    return convert_value(optarg, value);
+  }
+
+  template <typename T, bool (*Convert)(const void *, const char *, T &)>
+  static bool convert_handle_(const void *target, const char *optarg, void *value) {
+    return Convert(target, optarg, *static_cast<T *>(value));
+  }
+  template <typename T> static void construct_handle_(void *value) { new (value) T(); }
+  template <typename T> static void copy_handle_(void *value, const void *from) {
+    new (value) T(*static_cast<const T *>(from));
+  }
+  template <typename T> static void destroy_handle_(void *value) { static_cast<T *>(value)->~T(); }
+
+  // one descriptor per value type and conversion, shared by the slots
+  template <typename T, bool (*Convert)(const void *, const char *, T &)> static const handle_type *handle_type_of_() {
+    static const handle_type type{sizeof(T), alignof(T), &convert_handle_<T, Convert>, &construct_handle_<T>,
+                                  &copy_handle_<T>, &destroy_handle_<T>};
+    return &type;
+  }
+
+  /**
+   * The scan of try_parse(schema, object, argc, argv). Long names are resolved with the perfect hash of the schema
+   * instead of the linear search of getopt_long, every option takes a value, and argv is permuted like getopt_long
+   * does: the options first, then the non-options, with optind on the first of them.
+   */
+  static parse_result scan_schema_(const static_schema &schema, unsigned char *object, int argc, char *argv[]);
+
+  /**
+   * Prints the help and exits on -h, --help or an error, the behavior of parse() and parse_fd().
+   */
+  void exit_on_error_(const parse_result &result);
+
+  /**
+   * The parse of try_parse() in a new state, which records the dispatched options if its record is set. Every token
+   * goes through the token scanner, so long names are found in the trie, and argv is permuted like getopt_long does:
+   * the options first, then the non-options, with optind on the first of them.
+   */
+  parse_result scan_argv_(int argc, char *argv[], scan_state &state);
+
+  /**
+   * Completes an unambiguous abbreviation of a long option name, as getopt_long does, owner is nullptr otherwise.
+   */
+  option_ref abbreviated_(const char *name, size_t len);
+
+  /**
+   * Hashes the tokens after the program name, FNV-1a over the tokens and their terminators.
+   */
+  static uint64_t fingerprint_(int argc, char *argv[], uint64_t seed) {
+    uint64_t hash = 14695981039346656037ull ^ seed;
+    for (int i = 1; i < argc; ++i) {
+      for (const char *p = argv[i];; ++p) {
+        hash = (hash ^ static_cast<unsigned char>(*p)) * 1099511628211ull;
+        if (*p == '\0') {
+          break;
+        }
+      }
+    }
+    return hash;
+  }
+
+  // moves a cache entry to the front of the recency list
+  void touch_cached_(uint32_t index);
+
+  /**
+   * Builds an option with its strings and containers allocated from the resource of the parser.
+   */
+  operator_option make_option_(char short_name, string_ref long_name, string_ref help, Argument type,
+                               bool (*assign)(void *, const char *), void *target) const {
+    return operator_option{short_name,
+                           string_t(long_name.data(), long_name.size(), resource_),
+                           nullptr,
+                           string_t(help.data(), help.size(), resource_),
+                           type,
+                           nullptr,
+                           nullptr,
+                           vector_t<const char *>(resource_),
+                           0,
+                           assign,
+                           target,
+                           nullptr};
+  }
+
+  /**
+   * Registers an option, returns its slot or -1 if it is a duplicate.
+   */
+  int32_t add_option_(operator_option &&option);
+
+  bool was_set_(uint32_t slot) const { return (set_bits_[slot >> 6] >> (slot & 63)) & 1; }
+  bool scanned_(uint32_t slot) const { return (scan_bits_[slot >> 6] >> (slot & 63)) & 1; }
+
+  /**
+   * Starts a scan: forgets the options seen by the previous one in this parser and its parents, so the constraints
+   * only apply to a single command line.
+   */
+  void begin_scan_() {
+    for (TinyCmdline *cmd = this; cmd != nullptr; cmd = cmd->parent_) {
+      for (auto &bits : cmd->scan_bits_) {
+        bits = 0;
+      }
+    }
+  }
+
+  /**
+   * Finds the slot of an option of this parser named as on the command line, returns -1 if not found.
+   */
+  int32_t slot_of_(string_ref name) const;
+
+  void add_constraint_(constraint_kind kind, const string_ref *trigger, std::initializer_list<string_ref> names);
+
+  /**
+   * Checks the constraints of this parser against the options seen by the scan, appending a line per violation.
+   */
+  void check_constraints_(std::string &violations) const;
+
+  /**
+   * Ends a scan: checks the constraints if it succeeded, then flushes or drops the bulk values.
+   */
+  void end_scan_(parse_result &result) {
+    if (result) {
+      std::string violations;
+      for (const TinyCmdline *cmd = this; cmd != nullptr; cmd = cmd->parent_) {
+        if (cmd->constraint_check_ != nullptr) {
+          (cmd->*cmd->constraint_check_)(violations);
+        }
+      }
+      if (!violations.empty()) {
+        violations.pop_back();
+        result = {Error::constraint, violations};
+      }
+    }
+    flush_bulk_(!!result);
+    begin_scan_();
+  }
+
+  /**
+   * Reads a file descriptor until the end, passing every chunk to the callback, or until the callback returns false,
+   * so a failed scan does not wait for the writer to close. Returns false if a read fails, errno tells why.
+   */
+  template <typename F> static bool read_chunks_(int fd, F &&on_chunk);
+
+  /**
+   * Passes a value to a stream operator in chunks, so huge values are never held in memory. The value "-" streams
+   * stdin, "@path" streams the file at path, any other value is passed as a single chunk. A final call with
+   * (nullptr, 0) marks the end of the value. Returns false without the final call if the file cannot be opened or
+   * read, errno tells why.
+   */
+  static bool stream_value_(const stream_operator_t &f, const char *optarg);
+
+  // the argument of an Error::io result, the value that failed and the reason, as perror() prints them
+  static std::string io_failure_(const char *what) { return std::string(what ? what : "") + ": " + strerror(errno); }
+
+  /**
+   * Dispatches an option value. Values of a streaming scan are transient, so they are copied by keep when kept for
+   * bulk. Returns Error::bad_value if the value does not convert, Error::io if a stream value cannot be read.
+   */
+  static Error dispatch_(const option_ref &ref, const char *value,
+                         const char *(*keep)(TinyCmdline &, const char *) = nullptr) {
+    return ref.owner->dispatch_local_(ref.key, value, keep);
+  }
+
+  /**
+   * Dispatches an option value of this parser, returns false if the value failed to convert.
+   */
+  Error dispatch_local_(int32_t key, const char *value, const char *(*keep)(TinyCmdline &, const char *));
+
+  // the keep of a streaming scan, see dispatch_()
+  static const char *keep_transient_(TinyCmdline &owner, const char *value) {
+    return owner.bulk_strings_.store(value, strlen(value)).c_str();
+  }
+
+  /**
+   * Calls the bulk operators with the values collected during the scan, or drops them if the scan failed.
+   */
+  void flush_bulk_(bool call);
+
+  static void dispatch_prefix_(const option_ref &prefix, string_ref name, const char *value) {
+    prefix_of_(prefix).op(name, value);
+  }
+
+  static const operator_option &option_of_(const option_ref &ref) { return ref.owner->operators_.at(ref.key); }
+  static const prefix_option &prefix_of_(const option_ref &ref) { return ref.owner->prefixes_[ref.key]; }
+
+  /**
+   * Finds an option by key, the options of this parser hide the ones of the parents.
+   */
+  option_ref find_key_(int32_t key);
+
+  /**
+   * Finds an option and the longest prefix handler by long name, falling through to the parents.
+   */
+  long_match find_long_(const char *name, size_t len);
+
+  /**
+   * Checks whether an option of this parser has the key or the long name of an inherited option.
+   */
+  bool hides_(int32_t key, const operator_option &option) const;
+
+  /**
+   * Visits the options of this parser and the ones inherited from the parents that are not hidden.
+   */
+  void for_each_option_(const callable<void(int32_t, const operator_option &)> &f) const;
+
+  void scan_dispatch_(scan_state &state, const option_ref &ref, const char *value, const char *token);
+
+  /**
+   * The result of an option whose value failed to dispatch, naming the option and the broken check of a bad value.
+   */
+  static parse_result dispatch_failure_(Error error, const option_ref &ref, const char *value, std::string argument);
+
+  void scan_dispatch_prefix_(scan_state &state, const option_ref &prefix, string_ref name, const char *value);
+
+  /**
+   * Records an option of a preset instead of dispatching it, the divert of add_preset().
+   */
+  static Error take_preset_(scan_state &state, const argv_dispatch &dispatch);
+
+  /**
+   * Records a dispatched option for the parse cache, the record of try_parse_cached().
+   */
+  static void record_dispatch_(scan_state &state, const argv_dispatch &dispatch);
+
+  /**
+   * Applies a preset, a straight loop over its resolved arguments. The converter of the preset options.
+   */
+  static bool apply_preset_(void *target, const char *value);
+
+  /**
+   * Feeds one complete token of known size to the scanner, dispatching the option as soon as it and its value are
+   * known. Follows the getopt_long conventions: "--name", "--name=value", "--name value", "-abc", "-ovalue",
+   * "-o value" and "--" to end the options. A positional argument goes to scan_positional_(). After an error the
+   * tokens are ignored.
+   */
+  void scan_token_(scan_state &state, const char *token, size_t size);
+
+  void scan_token_(scan_state &state, const char *token) { scan_token_(state, token, strlen(token)); }
+
+  /**
+   * Passes a streamed positional argument to the handler of this parser or of its closest parent having one.
+   */
+  void scan_positional_(scan_state &state, const char *token);
+
+  /**
+   * Feeds the NUL-terminated tokens of a block, in place. An unterminated tail is kept in carry and completed by the
+   * next block.
+   */
+  void scan_block_(scan_state &state, const char *data, size_t size, string_t &carry);
+
+  /**
+   * Checks the scanner ends in a complete state, a required value must not be missing.
+   */
+  void scan_finish_(scan_state &state);
+
+  /**
+   * Records the first error of the scanner.
+   */
+  static void scan_fail_(scan_state &state, Error error, const std::string &argument) {
+    if (state.result) {
+      state.result = {error, argument};
+    }
+  }
+
+  /**
+   * Prints the usage information, automatically generated from the added arguments.
+   */
+  void usage_();
+
+  static void print_option_(char short_name, const char *long_name, Argument type, const char *help);
+
+ private:
+  int32_t opt_val_{static_cast<int32_t>(256)};  // std::numeric_limits<uint8_t>::max() + 1
+  TinyCmdline *parent_{nullptr};                 // parser of the inherited options, see TinyCmdline(parent)
+  memory_resource *resource_{default_resource()};  // of every container below, see TinyCmdline(resource)
+  map_t<int32_t, operator_option> operators_;
+  name_trie long_names_;                                        // long names to the keys of operators_ and prefixes_
+  vector_t<prefix_option> prefixes_;
+  vector_t<preset_option *> presets_;                           // in arena_, the preset options point to them
+  vector_t<int32_t> bulk_keys_;                                 // keys of the bulk options, in registration order
+  string_pool bulk_strings_;                                    // copies of the transient values kept for bulk
+  vector_t<void *> values_;                                     // values of the handles by slot, nullptr otherwise
+  vector_t<const handle_type *> handle_types_;                  // types of the handles by slot, nullptr otherwise
+  vector_t<uint64_t> set_bits_;                                 // options ever seen, one bit per slot, see was_set()
+  vector_t<uint64_t> scan_bits_;                                // options seen by the current scan, see constraints
+  vector_t<constraint> constraints_;                            // see add_required(), add_exclusive(), add_implies()
+  void (TinyCmdline::*constraint_check_)(std::string &) const {nullptr};  // check_constraints_() once one is added
+  value_arena arena_;
+  uint64_t schema_version_{0};                                  // see schema_version()
+  parse_cache *cache_{nullptr};                                 // in arena_, see set_parse_cache()
+  operator_t positional_;                                       // see set_positional_handler()
+
+  template <size_t MaxOptions, size_t MaxHelpSize> friend class FixedCmdline;
+};
+
+
+// value types instantiated once in tiny_cmdline.cpp with TINY_CMDLINE_COMPILED_LIB, they cannot be specialized then
+#define TINY_CMDLINE_COMMON_TYPES(X) \
+  X(int8_t) X(int16_t) X(int32_t) X(int64_t) X(uint8_t) X(uint16_t) X(uint32_t) X(uint64_t)
+
+// only the conversions that do not depend on TINY_CMDLINE_NO_EXCEPTIONS are compiled once, convert<T>::to() is not
+#ifdef TINY_CMDLINE_COMPILED_LIB
+#define TINY_CMDLINE_EXTERN_TEMPLATE(T)                                      \
+  extern template bool TinyCmdline::convert<T>::try_to(const char *, T &); \
+  extern template bool TinyCmdline::assign_field<T>(void *, const char *);
+TINY_CMDLINE_COMMON_TYPES(TINY_CMDLINE_EXTERN_TEMPLATE)
+#undef TINY_CMDLINE_EXTERN_TEMPLATE
+#endif
+
+}  // namespace TINY_CMDLINE_MODE
+}  // namespace tiny_cmdline
+
+/**
+ * Describes a field of a struct for TinyCmdline::bind(), e.g.
+ * TINY_CMDLINE_FIELD(ParsedArgs, port, "port", 'p', "The port to connect to.")
+ */
+#define TINY_CMDLINE_FIELD(type, member, long_name, short_name, help)                                  \
+  tiny_cmdline::TinyCmdline::field {                                                                   \
+    long_name, short_name, offsetof(type, member),                                                     \
+        &tiny_cmdline::TinyCmdline::assign_field<decltype(type::member)>, help                         \
+  }
+
+
+// Overlay, Snapshot and FixedCmdline, left out of the declarations with TINY_CMDLINE_COMPILED_LIB unless
+// TINY_CMDLINE_EXTRAS is defined before the header is included, so a translation unit using none of them does not
+// parse them and their headers
+#if !defined(TINY_CMDLINE_COMPILED_LIB) || defined(TINY_CMDLINE_IMPLEMENTATION) || defined(TINY_CMDLINE_EXTRAS)
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace tiny_cmdline {
+inline namespace TINY_CMDLINE_MODE {
+
+static_assert(static_cast<int>(TinyCmdline::Argument::none) == no_argument &&
+                  static_cast<int>(TinyCmdline::Argument::required) == required_argument &&
+                  static_cast<int>(TinyCmdline::Argument::optional) == optional_argument,
+              "Argument must match the has_arg values of getopt_long.");
+
+/**
+ * Sparse overrides of the handle values of a parser, e.g. the options carried by one request over the
+ * configuration parsed at startup. An overlay parses its tokens against the options of the parser and keeps only
+ * the converted values it overrides, the parser and its values are never modified, so the overlays of one parser
+ * can live on different threads while no parse of the parser is running. Reading a value the overlay does not
+ * override costs one bit test before falling through to the parser. The values are allocated from the resource,
+ * e.g. a monotonic_resource over a stack buffer, so an overlay can be created and dropped per request without
+ * reaching the global heap, unless a value allocates itself like a long std::string.
+ */
+class TinyCmdline::Overlay {
+ public:
+  /**
+   * @param base The parser of the options and the values read through, it must outlive the overlay.
+   * @param resource The resource of the overridden values, it must outlive the overlay.
+   */
+  explicit Overlay(TinyCmdline &base, memory_resource *resource = default_resource())
+      : base_(base), resource_(resource), entries_(resource) {}
+  Overlay(const Overlay &) = delete;
+  Overlay &operator=(const Overlay &) = delete;
+
+  ~Overlay() {
+    for (const auto &entry : entries_) {
+      release_(entry.type, entry.value);
+    }
+  }
+
+  /**
+   * Parses overriding tokens with the conventions of parse_fd(), a later token overrides an earlier one. Only
+   * the options read through a handle can be overridden, the others fail with Error::not_overridable. The
+   * constraints of the parser are not checked.
+   *
+   * @param count The number of tokens.
+   * @param tokens The tokens, without a program name.
+   * @return The result, the overrides before an error are kept.
+   */
+  parse_result parse(int count, const char *const tokens[]) {
+    scan_state state;
+    state.overlay = this;
+    state.divert = &take_;
+    for (int i = 0; i < count && state.result; ++i) {
+      base_.scan_token_(state, tokens[i]);
+    }
+    base_.scan_finish_(state);
+    return state.result;
+  }
+
+  template <typename T> const T &get(const Opt<T> &opt) const {
+    const void *value = find_(opt.owner_, opt.slot_);
+    return (value != nullptr) ? *static_cast<const T *>(value) : opt.get();
+  }
+  template <typename T> const T &operator[](const Opt<T> &opt) const { return get(opt); }
+
+  template <typename T> bool overrides(const Opt<T> &opt) const { return find_(opt.owner_, opt.slot_) != nullptr; }
+  size_t size() const { return entries_.size(); }
+
+ private:
+  friend class TinyCmdline;
+
+  struct entry {
+    const TinyCmdline *owner;
+    uint32_t slot;
+    const handle_type *type;
+    void *value;
+  };
+
+  const void *find_(const TinyCmdline *owner, uint32_t slot) const {
+    if (((filter_ >> (slot & 63)) & 1) == 0) {
+      return nullptr;
+    }
+    for (const auto &entry : entries_) {
+      if (entry.slot == slot && entry.owner == owner) {
+        return entry.value;
+      }
+    }
+    return nullptr;
+  }
+
+  void release_(const handle_type *type, void *value) {
+    type->destroy(value);
+    resource_->deallocate(value, type->size, type->align);
+  }
+
+  // the divert of the scan, a prefix handler has no value to override
+  static Error take_(scan_state &state, const argv_dispatch &dispatch) {
+    return dispatch.is_prefix ? Error::not_overridable : state.overlay->set_(dispatch.ref, dispatch.value);
+  }
+
+  // converts the value of an option into a new value of the overlay, replacing a previous one
+  Error set_(const option_ref &ref, const char *optarg) {
+    const auto &option = option_of_(ref);
+    const handle_type *type = ref.owner->handle_types_[option.slot];
+    if (type == nullptr) {
+      return Error::not_overridable;
+    }
+    void *value = resource_->allocate(type->size, type->align);
+    type->construct(value);
+    if (!type->convert(option.target, optarg, value)) {
+      release_(type, value);
+      return Error::bad_value;
+    }
+    for (auto &entry : entries_) {
+      if (entry.slot == option.slot && entry.owner == ref.owner) {
+        release_(entry.type, entry.value);
+        entry.value = value;
+        return Error::none;
+      }
+    }
+    entries_.push_back(entry{ref.owner, option.slot, type, value});
+    filter_ |= uint64_t{1} << (option.slot & 63);
+    return Error::none;
+  }
+
+  TinyCmdline &base_;
+  memory_resource *resource_;
+  vector_t<entry> entries_;  // the overrides, few per overlay
+  uint64_t filter_{0};       // bit slot % 64 is set if a slot with this remainder is overridden
+};
+
+/**
+ * Read-only replicas of the handle values of a parser, one per NUMA node, for values read at a high rate by
+ * threads on several sockets. Each replica is a cache-line aligned block placed on its node, and get() reads the
+ * replica of the node of the calling thread, so the hot reads stay on the node. publish() copies the current
+ * values into new replicas and switches the readers to them at once, e.g. after a reload. The characters of a
+ * string_ref value are copied into the replica too, so a later parse reusing the buffer of the option does not
+ * change it. The previous replicas stay valid for the readers still using them until reclaim() or the
+ * destruction. Only the handles of
+ * the parser itself are replicated, the handles of its parents are read from the parents. Without NUMA support,
+ * e.g. outside Linux, there is one replica.
+ */
+class TinyCmdline::Snapshot {
+ public:
+  /**
+   * Publishes the current values.
+   *
+   * @param cmd The parser of the values, it must outlive the snapshot and must not get new options.
+   * @param replicas The number of replicas, 0 for one per NUMA node.
+   */
+  explicit Snapshot(const TinyCmdline &cmd, size_t replicas = 0);
+  Snapshot(const Snapshot &) = delete;
+  Snapshot &operator=(const Snapshot &) = delete;
+  ~Snapshot();
+
+  /**
+   * Copies the current values of the parser into every replica, the readers switch to them atomically.
+   * Must not run concurrently with a parse of the parser or another publish().
+   */
+  void publish();
+
+  /**
+   * Frees the replicas replaced by publish(), once no reader can still be using them.
+   */
+  void reclaim();
+
+  template <typename T> const T &get(const Opt<T> &opt) const {
+    if (opt.owner_ != &cmd_) {
+      return opt.get();
+    }
+    const generation *current = current_.load(std::memory_order_acquire);
+    const unsigned char *replica = current->replicas[current_node() % current->replicas.size()];
+    return *reinterpret_cast<const T *>(replica + offsets_[opt.slot_]);
+  }
+  template <typename T> const T &operator[](const Opt<T> &opt) const { return get(opt); }
+
+  size_t replicas() const { return replica_count_; }
+
+  /**
+   * The NUMA node of the calling thread, looked up once per thread, so the readers should be pinned to a node.
+   */
+  static unsigned current_node();
+
+  /**
+   * The number of NUMA nodes of the system, 1 if unknown.
+   */
+  static unsigned node_count();
+
+ private:
+  struct generation {
+    std::vector<unsigned char *> replicas;  // replica i is placed on node i
+    size_t size;                            // of each replica, the values then the characters of the string_refs
+  };
+
+  static unsigned char *allocate_replica_(size_t size, unsigned node);
+  static void free_replica_(unsigned char *replica, size_t size);
+  void release_(generation *retired);
+
+  const TinyCmdline &cmd_;
+  size_t replica_count_;
+  size_t replica_size_{0};           // a multiple of the cache line
+  std::vector<size_t> offsets_;      // of the handle values in a replica by slot
+  std::atomic<generation *> current_{nullptr};
+  std::vector<generation *> retired_;  // replaced by publish(), freed by reclaim()
+};
+
+/**
+ * Fixed-capacity counterpart of TinyCmdline for code where the heap is off limits, e.g. before main or on a
+ * latency-critical path. The options, the getopt tables and the help live in inline arrays and nothing is ever
+ * allocated: names and help texts are not copied, so they must outlive the parser, e.g. string literals, and
+ * handlers must fit the inline buffer of a callable, which is checked at compile time. Registering past the
+ * capacity fails like a duplicate option does.
+ *
+ * @tparam MaxOptions The maximum number of options.
+ * @tparam MaxHelpSize The maximum size of the help text, including the terminating NUL.
+ */
+template <size_t MaxOptions, size_t MaxHelpSize = 64 * MaxOptions> class FixedCmdline {
+  static_assert(MaxOptions > 0 && MaxHelpSize > 0, "The capacity must not be empty.");
+
+ public:
+  using Argument = TinyCmdline::Argument;
+  using Error = TinyCmdline::Error;
+  using field = TinyCmdline::field;
+
+  /**
+   * Result of a parse, converts to true on success. Unlike TinyCmdline::parse_result the argument is not copied.
+   */
+  struct parse_result {
+    Error error;
+    const char *argument;  // the argument that failed, in argv, nullptr on success
+
+    explicit operator bool() const { return error == Error::none; }
+  };
+
+  FixedCmdline() {
+    std::fill(short_index_, short_index_ + 256, -1);
+    short_options_[0] = '\0';
+    long_options_[0] = option{nullptr, 0, nullptr, 0};
+    help_[0] = '\0';
+  }
+
+  /**
+   * Adds an argument handled by an operator function taking the value, or taking no parameter.
+   *
+   * @return false if the option is a duplicate or the capacity is exceeded.
+   */
+  template <typename T>
+  bool add_argument(const char *long_name, char short_name, T &&f, Argument type, const char *help = "") {
+    using decay_f = typename std::decay<T>::type;
+    constexpr bool is_operator_f = std::is_convertible<decay_f, TinyCmdline::operator_t>::value;
+    constexpr bool is_void_operator_f = std::is_convertible<decay_f, TinyCmdline::void_operator_t>::value;
+    static_assert(is_operator_f || is_void_operator_f, "The operator function must be operator_t or void_operator_t.");
+    static_assert(TinyCmdline::operator_t::stores_inline<T>(), "The operator function does not fit inline.");
+
+    fixed_option *added = add_option_(long_name, short_name, type, help);
+    if (added == nullptr) {
+      return false;
+    }
+    bind_operator_f(*added, std::forward<T>(f), std::integral_constant<bool, is_operator_f>());
+    return true;
+  }
+
+  /**
+   * Adds an argument setting a value, converted with TinyCmdline::convert<T>.
+   *
+   * @return false if the option is a duplicate or the capacity is exceeded.
+   */
+  template <typename T> bool add_argument(const char *long_name, char short_name, T &value, const char *help = "") {
+    fixed_option *added = add_option_(long_name, short_name, Argument::required, help);
+    if (added == nullptr) {
+      return false;
+    }
+    added->assign = &TinyCmdline::assign_field<T>;
+    added->target = &value;
+    return true;
+  }
+
+  /**
+   * Adds a flag setting a value to placed_val if present, to default_val otherwise.
+   *
+   * @return false if the option is a duplicate or the capacity is exceeded.
+   */
+  template <typename T, typename U>
+  bool add_argument(const char *long_name, char short_name, T &value, const U &default_val, const U &placed_val,
+                    const char *help = "") {
+    value = static_cast<T>(default_val);
+    return add_argument(long_name, short_name, [&value, placed_val]() { value = static_cast<T>(placed_val); },
+                        Argument::none, help);
+  }
+
+  /**
+   * Binds the fields of a struct, see TinyCmdline::bind().
+   *
+   * @return false if an option is a duplicate or the capacity is exceeded, the fields before it are bound.
+   */
+  template <typename S> bool bind(S &object, const field *fields, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      const field &f = fields[i];
+      fixed_option *added = add_option_(f.long_name, f.short_name, Argument::required, f.help);
+      if (added == nullptr) {
+        return false;
+      }
+      added->assign = f.assign;
+      added->target = reinterpret_cast<unsigned char *>(&object) + f.offset;
+    }
+    return true;
+  }
+
+  template <typename S> bool bind(S &object, std::initializer_list<field> fields) {
+    return bind(object, fields.begin(), fields.size());
+  }
+
+  size_t size() const { return count_; }
+
+  /**
+   * Prints the help, built while the options were added, or calls the handler of -h or --help if one was added.
+   */
+  void print_help() const {
+    for (size_t i = 0; i < count_; ++i) {
+      const fixed_option &opt = options_[i];
+      if ((opt.short_name == 'h' || (opt.long_name != nullptr && strcmp(opt.long_name, "help") == 0)) && opt.op) {
+        opt.op(nullptr);
+        return;
+      }
+    }
+    fputs(help_, stdout);
+  }
+
+  /**
+   * Parses the command line arguments. Prints the help and exits on -h, --help or any error.
+   */
+  void parse(int argc, char *argv[]) {
+    const parse_result result = try_parse(argc, argv);
+    if (!result) {
+      print_help();
+      exit(result.error == Error::help ? 0 : 1);
+    }
+  }
+
+  /**
+   * Parses the command line arguments, reporting -h, --help and errors through the result instead of exiting.
+   */
+  parse_result try_parse(int argc, char *argv[]) {
+    parse_result result{Error::none, nullptr};
+    int32_t c = 0;
+    int32_t option_index = 0;
+    const int32_t opterr_tmp = opterr;
+    opterr = 0;
+    while (result && (c = getopt_long(argc, argv, short_options_, long_options_, &option_index)) != -1) {
+      const char *argument = argv[optind - 1];
+      if (c == 'h' || strcmp(argument, "--help") == 0 || strcmp(argument, "-h") == 0) {
+        result = {Error::help, argument};
+        break;
+      }
+      const int32_t index = (c >= 256) ? c - 256 : (c == '?') ? -1 : short_index_[c & 0xff];
+      if (index < 0) {
+        result = {failure_(), argument};
+        break;
+      }
+      const fixed_option &opt = options_[index];
+      if (opt.assign != nullptr) {
+        if (!opt.assign(opt.target, optarg)) {
+          result = {Error::bad_value, argument};
+        }
+      } else {
+        opt.op(optarg);
+      }
+    }
+    opterr = opterr_tmp;
+    return result;
+  }
+
+ private:
+  struct fixed_option {
+    char short_name;
+    const char *long_name;                 // nullptr if none
+    Argument type;
+    TinyCmdline::operator_t op;            // always stored inline
+    bool (*assign)(void *, const char *);  // set instead of op for values, converts the value into target
+    void *target;
+  };
+
+  template <typename T> static void bind_operator_f(fixed_option &opt, T &&f, std::true_type) {
+    opt.op = TinyCmdline::operator_t(std::forward<T>(f));
+  }
+  template <typename T> static void bind_operator_f(fixed_option &opt, T &&f, std::false_type) {
+    opt.op = TinyCmdline::operator_t::dropping_arguments(std::forward<T>(f));
+  }
+
+  /**
+   * Tells why getopt_long returned '?'. optopt is the short name of a known short option lacking its value, the val
+   * of a known long option, 256 + its index, lacking its value or given one it does not take, and 0 or an unknown
+   * short name otherwise.
+   */
+  Error failure_() const {
+    if (optopt >= 256) {
+      const bool takes_none = options_[optopt - 256].type == Argument::none;
+      return takes_none ? Error::unexpected_value : Error::missing_value;
+    }
+    return (optopt != 0 && short_index_[optopt & 0xff] >= 0) ? Error::missing_value : Error::unknown_option;
+  }
+
+  /**
+   * Registers an option in the inline tables and appends it to the help, returns nullptr if it is a duplicate or
+   * does not fit.
+   */
+  fixed_option *add_option_(const char *long_name, char short_name, Argument type, const char *help) {
+    const bool has_long = (long_name != nullptr && long_name[0] != '\0');
+    bool duplicate = (short_name != '\0' && short_index_[static_cast<unsigned char>(short_name)] >= 0);
+    for (size_t i = 0; i < count_ && has_long && !duplicate; ++i) {
+      duplicate = (options_[i].long_name != nullptr && strcmp(options_[i].long_name, long_name) == 0);
+    }
+    if (duplicate) {
+      if (short_name == '\0') {
+        fprintf(stderr, "duplicate option --%s\n", long_name);
+      } else if (!has_long) {
+        fprintf(stderr, "duplicate option -%c\n", short_name);
+      } else {
+        fprintf(stderr, "duplicate option -%c, --%s\n", short_name, long_name);
+      }
+      return nullptr;
+    }
+    const char *arg_str = (type == Argument::required) ? " <arg> " : " ";
+    int written = 0;
+    if (short_name == '\0') {
+      written = snprintf(help_ + help_length_, MaxHelpSize - help_length_, "\t--%s%s%s\n", long_name, arg_str, help);
+    } else if (!has_long) {
+      written = snprintf(help_ + help_length_, MaxHelpSize - help_length_, "\t-%c%s%s\n", short_name, arg_str, help);
+    } else {
+      written = snprintf(help_ + help_length_, MaxHelpSize - help_length_, "\t-%c, --%s%s%s\n", short_name,
+                         long_name, arg_str, help);
+    }
+    if (count_ == MaxOptions || written < 0 || help_length_ + static_cast<size_t>(written) >= MaxHelpSize) {
+      help_[help_length_] = '\0';
+      fprintf(stderr, "no room for option -%c, --%s\n", short_name, has_long ? long_name : "");
+      return nullptr;
+    }
+    help_length_ += static_cast<size_t>(written);
+
+    const auto index = static_cast<int32_t>(count_);
+    if (short_name != '\0') {
+      short_index_[static_cast<unsigned char>(short_name)] = index;
+      short_options_[short_length_++] = short_name;
+      if (type != Argument::none) {
+        short_options_[short_length_++] = ':';
+      }
+      short_options_[short_length_] = '\0';
+    }
+    if (has_long) {
+      long_options_[long_count_++] = option{long_name, static_cast<int32_t>(type), nullptr, 256 + index};
+      long_options_[long_count_] = option{nullptr, 0, nullptr, 0};
+    }
+    fixed_option &added = options_[count_++];
+    added = fixed_option{short_name, has_long ? long_name : nullptr, type, nullptr, nullptr, nullptr};
+    return &added;
+  }
+
+  fixed_option options_[MaxOptions];
+  int32_t short_index_[256];                 // short name to the index in options_, -1 if unused
+  option long_options_[MaxOptions + 1];      // getopt long options, val is 256 + the index in options_
+  char short_options_[2 * MaxOptions + 1];   // getopt short options
+  char help_[MaxHelpSize];                   // usage text, in registration order
+  size_t count_{0};
+  size_t long_count_{0};
+  size_t short_length_{0};
+  size_t help_length_{0};
+};
+
+}  // namespace TINY_CMDLINE_MODE
+}  // namespace tiny_cmdline
+
+#endif
+
+#if !defined(TINY_CMDLINE_COMPILED_LIB) || defined(TINY_CMDLINE_IMPLEMENTATION)
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace tiny_cmdline {
+inline namespace TINY_CMDLINE_MODE {
+
+template <typename F>
+bool TinyCmdline::read_chunks_(int fd, F &&on_chunk) {
+  char chunk[stream_chunk_size];
+  ssize_t n = 0;
+  while ((n = read(fd, chunk, sizeof(chunk))) != 0) {
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (!on_chunk(chunk, static_cast<size_t>(n))) {
+      break;
+    }
+  }
+  return true;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::print_help() {
+  for (const TinyCmdline *cmd = this; cmd != nullptr; cmd = cmd->parent_) {
+    for (const auto &option : cmd->operators_) {
+      if ((option.second.short_name == 'h' || option.second.long_name == "help") && option.second.op) {
+        option.second.op(nullptr);
+        return;
+      }
+    }
+  }
+  usage_();
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::parse_result TinyCmdline::try_parse(int argc, char *argv[]) {
+  scan_state state;
+  return scan_argv_(argc, argv, state);
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::parse_result TinyCmdline::scan_argv_(int argc, char *argv[], scan_state &state) {
+  begin_scan_();
+  state.from_argv = true;
+  int first = 1;  // the options are moved before argv[first], the non-options skipped so far follow it
+  int i = 1;
+  while (i < argc && state.result && !state.terminated) {
+    const char *token = argv[i];
+    // a non-option is told by its first bytes and skipped without measuring it
+    if (token[0] != '-' || token[1] == '\0') {
+      ++i;
+      continue;
+    }
+    scan_token_(state, token, strlen(token));
+    int taken = 1;
+    if ((state.pending.owner != nullptr || state.pending_prefix.owner != nullptr) && i + 1 < argc) {
+      // the pending value is taken whole, its size is not used
+      scan_token_(state, argv[i + 1], 0);
+      taken = 2;
+    }
+    std::rotate(argv + first, argv + i, argv + i + taken);
+    first += taken;
+    i += taken;
+  }
+  if (state.pending.owner != nullptr || state.pending_prefix.owner != nullptr) {
+    // the last option lacks its value, named as written like getopt_long does, it was moved just before argv[first]
+    scan_fail_(state, Error::missing_value, argv[first - 1]);
+  }
+  optind = first;
+  end_scan_(state.result);
+  return state.result;
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::option_ref TinyCmdline::abbreviated_(const char *name, size_t len) {
+  int32_t match = -1;
+  bool ambiguous = false;
+  for_each_option_([name, len, &match, &ambiguous](int32_t key, const operator_option &option) {
+    if (option.long_name.size() > len && memcmp(option.long_name.data(), name, len) == 0) {
+      ambiguous = ambiguous || match >= 0;
+      match = key;
+    }
+  });
+  return (match >= 0 && !ambiguous) ? find_key_(match) : option_ref{nullptr, -1};
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::set_string_interning(bool enabled) {
+  bulk_strings_.set_interning(enabled);
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::set_parse_cache(size_t capacity) {
+  if (cache_ == nullptr) {
+    if (capacity == 0) {
+      return;
+    }
+    cache_ = arena_.create<parse_cache>(resource_);
+  }
+  cache_->capacity = std::min(capacity, static_cast<size_t>(no_entry));
+  vector_t<cache_entry>(resource_).swap(cache_->entries);  // frees the entries, they only grow back on a miss
+  cache_->index.clear();
+  cache_->newest = cache_->oldest = no_entry;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::touch_cached_(uint32_t index) {
+  auto &entries = cache_->entries;
+  cache_entry &entry = entries[index];
+  if (index == cache_->newest) {
+    return;
+  }
+  // unlink, it has a newer entry since it is not the newest
+  entries[entry.newer].older = entry.older;
+  if (entry.older != no_entry) {
+    entries[entry.older].newer = entry.newer;
+  } else {
+    cache_->oldest = entry.newer;
+  }
+  entry.newer = no_entry;
+  entry.older = cache_->newest;
+  entries[cache_->newest].newer = index;
+  cache_->newest = index;
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::parse_result TinyCmdline::try_parse_cached(int argc, char *argv[]) {
+  if (cache_ == nullptr || cache_->capacity == 0) {
+    return try_parse(argc, argv);
+  }
+  const uint64_t schema = schema_version();
+  if (schema != cache_->schema) {
+    set_parse_cache(cache_->capacity);
+    cache_->schema = schema;
+  }
+  auto &entries = cache_->entries;
+  const uint64_t fingerprint = fingerprint_(argc, argv, schema);
+  const auto found = cache_->index.find(fingerprint);
+  vector_t<char *> original(argv, argv + argc, resource_);
+  if (found != cache_->index.end()) {
+    const cache_entry &entry = entries[found->second];
+    const char *token = entry.tokens.c_str();
+    const char *tokens_end = token + entry.tokens.size();
+    int i = 1;
+    for (; i < argc && token < tokens_end && strcmp(token, argv[i]) == 0; ++i) {
+      token += strlen(token) + 1;
+    }
+    if (i == argc && token == tokens_end) {
+      begin_scan_();
+      touch_cached_(found->second);
+      parse_result result{Error::none, {}};
+      // the values are taken from this argv, so a handler may keep them as long as a scanned value
+      const auto in_argv = [&original](const argv_position &position) -> const char * {
+        return (position.token < 0) ? nullptr : original[static_cast<size_t>(position.token)] + position.offset;
+      };
+      for (const auto &dispatched : entry.dispatches) {
+        const char *value = in_argv(dispatched.value);
+        if (dispatched.is_prefix) {
+          dispatch_prefix_(dispatched.ref, string_ref(in_argv(dispatched.name), dispatched.name_size), value);
+        } else {
+          const Error error = dispatch_(dispatched.ref, value);
+          if (error != Error::none) {
+            result = dispatch_failure_(error, dispatched.ref, value,
+                                       (error == Error::io) ? io_failure_(value) : std::string(value ? value : ""));
+            break;
+          }
+        }
+      }
+      for (int j = 0; j < argc; ++j) {
+        argv[j] = original[static_cast<size_t>(entry.order[static_cast<size_t>(j)])];
+      }
+      optind = entry.optind;
+      end_scan_(result);
+      return result;
+    }
+  }
+
+  vector_t<argv_dispatch> record(resource_);
+  scan_state state;
+  state.recorded = &record;
+  state.record = &record_dispatch_;
+  parse_result result = scan_argv_(argc, argv, state);
+  if (!result) {
+    return result;
+  }
+  // a collision replaces the entry of the fingerprint, otherwise the oldest entry is reused beyond the capacity
+  uint32_t index = (found != cache_->index.end()) ? found->second : static_cast<uint32_t>(entries.size());
+  if (found == cache_->index.end() && entries.size() == cache_->capacity) {
+    index = cache_->oldest;
+    cache_->index.erase(entries[index].fingerprint);
+  }
+  if (index == entries.size()) {
+    entries.push_back(cache_entry{0, string_t(resource_), vector_t<cached_dispatch>(resource_),
+                                  vector_t<int32_t>(resource_), 0, no_entry, cache_->newest});
+    if (cache_->newest != no_entry) {
+      entries[cache_->newest].newer = index;
+    }
+    cache_->newest = index;
+    cache_->oldest = (cache_->oldest == no_entry) ? index : cache_->oldest;
+  } else {
+    touch_cached_(index);
+  }
+  cache_->index[fingerprint] = index;
+
+  cache_entry &entry = entries[index];
+  entry.fingerprint = fingerprint;
+  entry.tokens.clear();
+  for (int i = 1; i < argc; ++i) {
+    entry.tokens.append(original[static_cast<size_t>(i)]).push_back('\0');
+  }
+  // the scan only permutes the pointers, so every pointer of argv is found in the original one
+  vector_t<std::pair<const char *, int32_t>> positions(resource_);
+  for (int i = 0; i < argc; ++i) {
+    positions.emplace_back(original[static_cast<size_t>(i)], i);
+  }
+  std::sort(positions.begin(), positions.end());
+  entry.order.clear();
+  for (int i = 0; i < argc; ++i) {
+    const std::pair<const char *, int32_t> pointer(argv[i], 0);
+    entry.order.push_back(std::lower_bound(positions.begin(), positions.end(), pointer)->second);
+  }
+  // a recorded string lies in the last token starting at or before it
+  const auto position_of = [&positions](const char *p) -> argv_position {
+    if (p == nullptr) {
+      return argv_position{-1, 0};
+    }
+    const auto token = std::upper_bound(positions.begin(), positions.end(), std::make_pair(p, INT32_MAX)) - 1;
+    return argv_position{token->second, static_cast<uint32_t>(p - token->first)};
+  };
+  entry.dispatches.clear();
+  for (const auto &dispatched : record) {
+    entry.dispatches.push_back(cached_dispatch{dispatched.ref, dispatched.is_prefix, position_of(dispatched.value),
+                                               position_of(dispatched.name),
+                                               static_cast<uint32_t>(dispatched.name_size)});
+  }
+  entry.optind = optind;
+  return result;
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::parse_result TinyCmdline::try_parse_fd(int fd) {
+  string_t carry(resource_);
+  scan_state state;
+  state.keep = &keep_transient_;
+  begin_scan_();
+  const auto on_chunk = [this, &carry, &state](const char *data, size_t size) {
+    scan_block_(state, data, size, carry);
+    return !!state.result;  // the tokens after an error are ignored, so they are not read
+  };
+  if (!read_chunks_(fd, on_chunk)) {
+    scan_fail_(state, Error::io, io_failure_("read"));
+  }
+  // the last token may come without a terminator
+  if (state.result && !carry.empty()) {
+    scan_token_(state, carry.c_str(), carry.size());
+  }
+  scan_finish_(state);
+  end_scan_(state.result);
+  return state.result;
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::parse_result TinyCmdline::try_parse_block(const char *data, size_t size) {
+  string_t carry(resource_);
+  scan_state state;
+  state.keep = &keep_transient_;
+  begin_scan_();
+  scan_block_(state, data, size, carry);
+  if (!carry.empty()) {
+    scan_token_(state, carry.c_str(), carry.size());
+  }
+  scan_finish_(state);
+  end_scan_(state.result);
+  return state.result;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::scan_block_(scan_state &state, const char *data, size_t size, string_t &carry) {
+  const char *end = data + size;
+  while (data < end && state.result) {
+    const char *nul = static_cast<const char *>(memchr(data, '\0', static_cast<size_t>(end - data)));
+    if (nul == nullptr) {
+      carry.append(data, end);
+      return;
+    }
+    if (carry.empty()) {
+      // the token is terminated in the block, its length is known from the split
+      scan_token_(state, data, static_cast<size_t>(nul - data));
+    } else {
+      carry.append(data, nul);
+      scan_token_(state, carry.c_str(), carry.size());
+      carry.clear();
+    }
+    data = nul + 1;
+  }
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::add_prefix_argument(string_ref prefix, prefix_operator_t f, Argument type,
+                                                          string_ref help) {
+  string_t name(prefix.data(), prefix.size(), resource_);
+  name += '.';
+  long_names_.insert(name.c_str(), name.size(), static_cast<int32_t>(prefixes_.size()), true);
+  prefixes_.push_back(prefix_option{string_t(prefix.data(), prefix.size(), resource_), std::move(f),
+                                    string_t(help.data(), help.size(), resource_), type});
+  ++schema_version_;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::add_preset(string_ref long_name, string_ref value, string_ref arguments) {
+  auto it = std::find_if(presets_.begin(), presets_.end(),
+                         [&long_name](const preset_option *preset) { return long_name == preset->long_name; });
+  if (it == presets_.end()) {
+    presets_.push_back(arena_.create<preset_option>(long_name, resource_));
+    if (add_option_(make_option_('\0', long_name, "", Argument::required, &apply_preset_, presets_.back())) < 0) {
+      presets_.pop_back();
+      return;
+    }
+    it = presets_.end() - 1;
+  }
+  scan_state state;
+  vector_t<preset_value> resolved(resource_);
+  state.preset = &resolved;
+  state.divert = &take_preset_;
+  string_t token(resource_);
+  for (const char *begin = arguments.begin(), *end = begin; begin < arguments.end(); begin = end + 1) {
+    end = std::find_if(begin, arguments.end(), [](char c) { return c == ' ' || c == '\t' || c == '\n'; });
+    if (end > begin) {
+      token.assign(begin, end);
+      scan_token_(state, token.c_str(), token.size());
+    }
+  }
+  scan_finish_(state);
+  if (!state.result) {
+    fprintf(stderr, "bad argument %s in preset --%.*s=%.*s\n", state.result.argument.c_str(),
+            static_cast<int>(long_name.size()), long_name.data(), static_cast<int>(value.size()), value.data());
+    return;
+  }
+  (*it)->presets.emplace_back(string_t(value.data(), value.size(), resource_), std::move(resolved));
+  ++schema_version_;
+
+  // the help lists the presets
+  string_t help("One of: ", resource_);
+  for (const auto &preset : (*it)->presets) {
+    help.append(preset.first).append(&preset == &(*it)->presets.back() ? "." : ", ");
+  }
+  operators_.at(find_long_(long_name.data(), long_name.size()).option.key).help = help;
+}
+
+// Thompson construction of the NFA of a pattern, every fragment is a contiguous range of nodes with one entry and
+// one exit, so a bounded repetition copies the nodes of its operand
+struct TinyCmdline::pattern::compiler {
+  struct byte_set {
+    uint64_t bits[4];
+
+    void add(unsigned char c) { bits[c >> 6] |= uint64_t{1} << (c & 63); }
+    bool has(unsigned char c) const { return (bits[c >> 6] >> (c & 63)) & 1; }
+    void invert() {
+      for (auto &word : bits) {
+        word = ~word;
+      }
+    }
+  };
+
+  struct node {
+    byte_set set;
+    bool consumes;   // moves to next on a byte of set, otherwise only the epsilon moves
+    int32_t next;
+    int32_t eps[2];  // epsilon moves, -1 if unused
+  };
+
+  struct fragment {
+    int32_t start;
+    int32_t end;  // has no move yet
+  };
+
+  template <typename K, typename V>
+  using ordered_t = std::map<K, V, std::less<K>, resource_allocator<std::pair<const K, V>>>;
+
+  const char *expression;
+  size_t pos;
+  vector_t<node> nodes;
+  bool failed;
+
+  char peek() const { return expression[pos]; }
+
+  int32_t add_node() {
+    nodes.push_back(node{byte_set{{0, 0, 0, 0}}, false, -1, {-1, -1}});
+    return static_cast<int32_t>(nodes.size() - 1);
+  }
+
+  void link(int32_t from, int32_t to) {
+    auto &eps = nodes[static_cast<size_t>(from)].eps;
+    (eps[0] < 0 ? eps[0] : eps[1]) = to;
+  }
+
+  fragment consume(const byte_set &set) {
+    const fragment result{add_node(), add_node()};
+    nodes[static_cast<size_t>(result.start)].set = set;
+    nodes[static_cast<size_t>(result.start)].consumes = true;
+    nodes[static_cast<size_t>(result.start)].next = result.end;
+    return result;
+  }
+
+  fragment empty() {
+    const fragment result{add_node(), add_node()};
+    link(result.start, result.end);
+    return result;
+  }
+
+  fragment concat(const fragment &a, const fragment &b) {
+    link(a.end, b.start);
+    return {a.start, b.end};
+  }
+
+  fragment star(const fragment &f) {
+    const fragment result{add_node(), add_node()};
+    link(result.start, f.start);
+    link(result.start, result.end);
+    link(f.end, f.start);
+    link(f.end, result.end);
+    return result;
+  }
+
+  fragment plus(const fragment &f) {
+    const int32_t end = add_node();
+    link(f.end, f.start);
+    link(f.end, end);
+    return {f.start, end};
+  }
+
+  fragment optional(const fragment &f) {
+    const fragment result{add_node(), add_node()};
+    link(result.start, f.start);
+    link(result.start, result.end);
+    link(f.end, result.end);
+    return result;
+  }
+
+  // copies the nodes [first, last) of a fragment, its moves stay inside the range
+  fragment copy(const fragment &f, size_t first, size_t last) {
+    const auto offset = static_cast<int32_t>(nodes.size() - first);
+    for (size_t i = first; i < last; ++i) {
+      node n = nodes[i];
+      n.next = (n.next < 0) ? -1 : n.next + offset;
+      n.eps[0] = (n.eps[0] < 0) ? -1 : n.eps[0] + offset;
+      n.eps[1] = (n.eps[1] < 0) ? -1 : n.eps[1] + offset;
+      nodes.push_back(n);
+    }
+    return {f.start + offset, f.end + offset};
+  }
+
+  fragment alternation() {
+    fragment result = sequence();
+    while (!failed && peek() == '|') {
+      ++pos;
+      const fragment other = sequence();
+      const fragment joined{add_node(), add_node()};
+      link(joined.start, result.start);
+      link(joined.start, other.start);
+      link(result.end, joined.end);
+      link(other.end, joined.end);
+      result = joined;
+    }
+    return result;
+  }
+
+  fragment sequence() {
+    fragment result = empty();
+    while (!failed && peek() != '\0' && peek() != '|' && peek() != ')') {
+      result = concat(result, repetition());
+    }
+    return result;
+  }
+
+  fragment repetition() {
+    const size_t first = nodes.size();
+    fragment result = atom();
+    while (!failed) {
+      const char c = peek();
+      if (c == '*' || c == '+' || c == '?') {
+        ++pos;
+        result = (c == '*') ? star(result) : (c == '+') ? plus(result) : optional(result);
+      } else if (c == '{') {
+        result = bounded(result, first);
+      } else {
+        break;
+      }
+    }
+    return result;
+  }
+
+  uint32_t number() {
+    uint32_t value = 0;
+    const size_t begin = pos;
+    while (peek() >= '0' && peek() <= '9' && value <= max_bound) {
+      value = value * 10 + static_cast<uint32_t>(peek() - '0');
+      ++pos;
+    }
+    failed = failed || pos == begin || value > max_bound;
+    return value;
+  }
+
+  // "{m}", "{m,}" or "{m,n}" after the fragment built from nodes[first]
+  fragment bounded(const fragment &f, size_t first) {
+    ++pos;
+    const uint32_t min = number();
+    uint32_t max = min;
+    bool unbounded = false;
+    if (!failed && peek() == ',') {
+      ++pos;
+      unbounded = (peek() == '}');
+      max = unbounded ? min : number();
+    }
+    if (failed || peek() != '}' || max < min) {
+      failed = true;
+      return f;
+    }
+    ++pos;
+    const size_t last = nodes.size();
+    fragment result = empty();
+    for (uint32_t i = 0; i < max; ++i) {
+      const fragment copied = copy(f, first, last);
+      result = concat(result, (i < min) ? copied : optional(copied));
+    }
+    if (unbounded) {
+      result = concat(result, star(copy(f, first, last)));
+    }
+    return result;
+  }
+
+  fragment atom() {
+    byte_set set{{0, 0, 0, 0}};
+    const char c = peek();
+    switch (c) {
+      case '(': {
+        ++pos;
+        const fragment group = alternation();
+        if (peek() != ')') {
+          failed = true;
+          return group;
+        }
+        ++pos;
+        return group;
+      }
+      case '[':
+        ++pos;
+        bracket(set);
+        break;
+      case '.':
+        ++pos;
+        set.invert();
+        break;
+      case '\\':
+        ++pos;
+        escape(set);
+        break;
+      case '\0':
+      case '*':
+      case '+':
+      case '?':
+      case '{':
+      case '|':
+      case ')':
+        failed = true;
+        break;
+      default:
+        ++pos;
+        set.add(static_cast<unsigned char>(c));
+        break;
+    }
+    return consume(set);
+  }
+
+  void escape(byte_set &set) {
+    const char c = expression[pos++];
+    byte_set named{{0, 0, 0, 0}};
+    switch (c) {
+      case 'd':
+      case 'D':
+        for (unsigned char b = '0'; b <= '9'; ++b) {
+          named.add(b);
+        }
+        break;
+      case 'w':
+      case 'W':
+        for (unsigned b = 0; b < 256; ++b) {
+          if ((b >= '0' && b <= '9') || (b >= 'a' && b <= 'z') || (b >= 'A' && b <= 'Z') || b == '_') {
+            named.add(static_cast<unsigned char>(b));
+          }
+        }
+        break;
+      case 's':
+      case 'S':
+        for (const char *space = " \t\n\r\f\v"; *space != '\0'; ++space) {
+          named.add(static_cast<unsigned char>(*space));
+        }
+        break;
+      case 'n':
+        set.add('\n');
+        return;
+      case 't':
+        set.add('\t');
+        return;
+      case '\0':
+        failed = true;
+        --pos;
+        return;
+      default:
+        set.add(static_cast<unsigned char>(c));
+        return;
+    }
+    if (c == 'D' || c == 'W' || c == 'S') {
+      named.invert();
+    }
+    for (size_t i = 0; i < 4; ++i) {
+      set.bits[i] |= named.bits[i];
+    }
+  }
+
+  // a class after its '[', a ']' first in the class is a literal
+  void bracket(byte_set &set) {
+    const bool negated = (peek() == '^');
+    pos += negated ? 1 : 0;
+    bool first = true;
+    while (!failed && (first || peek() != ']')) {
+      first = false;
+      const char c = peek();
+      if (c == '\0') {
+        failed = true;
+        return;
+      }
+      ++pos;
+      if (c == '\\') {
+        escape(set);
+        continue;
+      }
+      if (peek() == '-' && expression[pos + 1] != ']' && expression[pos + 1] != '\0') {
+        const auto high = static_cast<unsigned char>(expression[pos + 1]);
+        pos += 2;
+        for (unsigned b = static_cast<unsigned char>(c); b <= high; ++b) {
+          set.add(static_cast<unsigned char>(b));
+        }
+        continue;
+      }
+      set.add(static_cast<unsigned char>(c));
+    }
+    ++pos;
+    if (negated) {
+      set.invert();
+    }
+  }
+
+  void closure(vector_t<int32_t> &states) const {
+    vector_t<int32_t> stack(states);
+    vector_t<bool> seen(nodes.size(), false, nodes.get_allocator());
+    for (const auto state : states) {
+      seen[static_cast<size_t>(state)] = true;
+    }
+    while (!stack.empty()) {
+      const node &n = nodes[static_cast<size_t>(stack.back())];
+      stack.pop_back();
+      for (const auto next : n.eps) {
+        if (next >= 0 && !seen[static_cast<size_t>(next)]) {
+          seen[static_cast<size_t>(next)] = true;
+          states.push_back(next);
+          stack.push_back(next);
+        }
+      }
+    }
+    std::sort(states.begin(), states.end());
+  }
+};
+
+TINY_CMDLINE_INLINE TinyCmdline::pattern::pattern(const char *expression, memory_resource *resource)
+    : table_(resource), accepting_(resource) {
+  compiler c{expression, 0, vector_t<compiler::node>(resource), false};
+  const compiler::fragment whole = c.alternation();
+  if (c.failed || c.peek() != '\0') {
+    fprintf(stderr, "bad pattern %s\n", expression);
+    return;
+  }
+
+  // the bytes consumed by the same nodes share a class, a row of the table has one entry per class
+  compiler::ordered_t<vector_t<bool>, uint8_t> class_ids(resource);
+  vector_t<unsigned char> representatives(resource);
+  vector_t<bool> signature(resource);
+  for (unsigned b = 0; b < 256; ++b) {
+    signature.clear();
+    for (const auto &n : c.nodes) {
+      signature.push_back(n.consumes && n.set.has(static_cast<unsigned char>(b)));
+    }
+    const auto inserted = class_ids.emplace(signature, static_cast<uint8_t>(representatives.size()));
+    if (inserted.second) {
+      representatives.push_back(static_cast<unsigned char>(b));
+    }
+    classes_[b] = inserted.first->second;
+  }
+  class_count_ = representatives.size();
+
+  // subset construction, the DFA states are the closed sets of NFA nodes
+  compiler::ordered_t<vector_t<int32_t>, int32_t> state_ids(resource);
+  vector_t<vector_t<int32_t>> sets(1, vector_t<int32_t>(1, whole.start, resource), resource);
+  c.closure(sets[0]);
+  state_ids.emplace(sets[0], 0);
+  vector_t<int32_t> moved(resource);
+  for (size_t i = 0; i < sets.size(); ++i) {
+    accepting_.push_back(std::binary_search(sets[i].begin(), sets[i].end(), whole.end) ? 1 : 0);
+    for (const auto byte : representatives) {
+      moved.clear();
+      for (const auto state : sets[i]) {
+        const auto &n = c.nodes[static_cast<size_t>(state)];
+        if (n.consumes && n.set.has(byte)) {
+          moved.push_back(n.next);
+        }
+      }
+      if (moved.empty()) {
+        table_.push_back(-1);
+        continue;
+      }
+      c.closure(moved);
+      const auto inserted = state_ids.emplace(moved, static_cast<int32_t>(sets.size()));
+      if (inserted.second) {
+        if (sets.size() == max_states) {
+          fprintf(stderr, "pattern %s needs more than %zu states\n", expression, max_states);
+          table_.clear();
+          accepting_.clear();
+          return;
+        }
+        sets.push_back(moved);
+      }
+      table_.push_back(inserted.first->second);
+    }
+  }
+  start_ = 0;
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::Snapshot::Snapshot(const TinyCmdline &cmd, size_t replicas)
+    : cmd_(cmd), replica_count_((replicas == 0) ? node_count() : replicas), offsets_(cmd.handle_types_.size(), 0) {
+  constexpr size_t cache_line = 64;
+  for (size_t slot = 0; slot < offsets_.size(); ++slot) {
+    const handle_type *type = cmd.handle_types_[slot];
+    if (type != nullptr) {
+      offsets_[slot] = (replica_size_ + type->align - 1) / type->align * type->align;
+      replica_size_ = offsets_[slot] + type->size;
+    }
+  }
+  replica_size_ = std::max<size_t>((replica_size_ + cache_line - 1) / cache_line * cache_line, cache_line);
+  publish();
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::Snapshot::~Snapshot() {
+  reclaim();
+  release_(current_.load());
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::Snapshot::reclaim() {
+  for (auto *retired : retired_) {
+    release_(retired);
+  }
+  retired_.clear();
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::Snapshot::publish() {
+  // a string_ref value views the buffer of its option, reused by the next parse, so its characters are copied too
+  const handle_type *viewed = handle_type_of_<string_ref, &convert_viewed_>();
+  size_t size = replica_size_;
+  for (size_t slot = 0; slot < offsets_.size(); ++slot) {
+    if (cmd_.handle_types_[slot] == viewed) {
+      size += static_cast<const string_ref *>(cmd_.values_[slot])->size() + 1;
+    }
+  }
+  auto *next = new generation{{}, size};
+  for (size_t node = 0; node < replica_count_; ++node) {
+    unsigned char *replica = allocate_replica_(size, static_cast<unsigned>(node));
+    char *characters = reinterpret_cast<char *>(replica + replica_size_);
+    for (size_t slot = 0; slot < offsets_.size(); ++slot) {
+      const handle_type *type = cmd_.handle_types_[slot];
+      if (type == viewed) {
+        const auto &value = *static_cast<const string_ref *>(cmd_.values_[slot]);
+        memcpy(characters, value.data(), value.size());
+        characters[value.size()] = '\0';
+        new (replica + offsets_[slot]) string_ref(characters, value.size());
+        characters += value.size() + 1;
+      } else if (type != nullptr) {
+        type->copy(replica + offsets_[slot], cmd_.values_[slot]);
+      }
+    }
+    next->replicas.push_back(replica);
+  }
+  generation *previous = current_.exchange(next, std::memory_order_acq_rel);
+  if (previous != nullptr) {
+    retired_.push_back(previous);
+  }
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::Snapshot::release_(generation *retired) {
+  for (auto *replica : retired->replicas) {
+    for (size_t slot = 0; slot < offsets_.size(); ++slot) {
+      const handle_type *type = cmd_.handle_types_[slot];
+      if (type != nullptr) {
+        type->destroy(replica + offsets_[slot]);
+      }
+    }
+    free_replica_(replica, retired->size);
+  }
+  delete retired;
+}
+
+TINY_CMDLINE_INLINE unsigned char *TinyCmdline::Snapshot::allocate_replica_(size_t size, unsigned node) {
+#ifdef __linux__
+  void *replica = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (replica == MAP_FAILED) {
+    perror("mmap");
+    exit(1);
+  }
+#ifdef SYS_mbind
+  // the pages are placed on their first write, so the preferred node is set before the values are copied, a
+  // kernel without NUMA support fails the call and the replica stays where it is
+  constexpr size_t mask_bits = 8 * sizeof(unsigned long);
+  std::vector<unsigned long> mask(node / mask_bits + 1, 0);
+  mask[node / mask_bits] |= 1ul << (node % mask_bits);
+  constexpr int preferred = 1;  // MPOL_PREFERRED
+  syscall(SYS_mbind, replica, size, preferred, mask.data(), mask.size() * mask_bits + 1, 0);
+#endif
+  return static_cast<unsigned char *>(replica);
+#else
+  (void)node;
+  void *replica = nullptr;
+  if (posix_memalign(&replica, 64, size) != 0) {
+    perror("posix_memalign");
+    exit(1);
+  }
+  return static_cast<unsigned char *>(replica);
+#endif
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::Snapshot::free_replica_(unsigned char *replica, size_t size) {
+#ifdef __linux__
+  munmap(replica, size);
+#else
+  (void)size;
+  free(replica);
+#endif
+}
+
+TINY_CMDLINE_INLINE unsigned TinyCmdline::Snapshot::current_node() {
+#if defined(__linux__) && defined(SYS_getcpu)
+  static thread_local const unsigned node = []() {
+    unsigned cpu = 0;
+    unsigned found = 0;
+    return (syscall(SYS_getcpu, &cpu, &found, nullptr) == 0) ? found : 0u;
+  }();
+  return node;
+#else
+  return 0;
+#endif
+}
+
+TINY_CMDLINE_INLINE unsigned TinyCmdline::Snapshot::node_count() {
+  // the online nodes are listed as ranges, e.g. "0-1" or "0,2-3", the count is the highest node plus one
+  FILE *file = fopen("/sys/devices/system/node/online", "r");
+  if (file == nullptr) {
+    return 1;
+  }
+  char list[256] = {};
+  const bool read = fgets(list, sizeof(list), file) != nullptr;
+  fclose(file);
+  unsigned highest = 0;
+  for (const char *p = list; read && *p != '\0'; ++p) {
+    if (*p >= '0' && *p <= '9' && (p == list || p[-1] < '0' || p[-1] > '9')) {
+      highest = std::max(highest, static_cast<unsigned>(strtoul(p, nullptr, 10)));
+    }
+  }
+  return highest + 1;
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::parse_result TinyCmdline::scan_schema_(const static_schema &schema,
+                                                                      unsigned char *object, int argc, char *argv[]) {
+  int first = 1;  // the options are moved before argv[first], the non-options skipped so far follow it
+  int i = 1;
+  while (i < argc) {
+    char *token = argv[i];
+    if (token[0] != '-' || token[1] == '\0') {
+      ++i;
+      continue;
+    }
+    if (token[1] == '-' && token[2] == '\0') {
+      // "--" ends the options, the non-options skipped so far go after it
+      std::rotate(argv + first, argv + i, argv + i + 1);
+      ++first;
+      break;
+    }
+    int32_t index = -1;
+    const char *value = nullptr;
+    if (token[1] == '-') {
+      const char *name = token + 2;
+      const char *equals = strchr(name, '=');
+      const size_t len = (equals != nullptr) ? static_cast<size_t>(equals - name) : strlen(name);
+      if (len == 4 && memcmp(name, "help", 4) == 0) {
+        optind = i + 1;
+        return {Error::help, token};
+      }
+      index = schema.find(name, len);
+      value = (equals != nullptr) ? equals + 1 : nullptr;
+    } else {
+      if (token[1] == 'h') {
+        optind = i + 1;
+        return {Error::help, token};
+      }
+      index = schema.short_fields[static_cast<unsigned char>(token[1])];
+      value = (token[2] != '\0') ? token + 2 : nullptr;
+    }
+    if (index < 0) {
+      optind = i + 1;
+      return {Error::unknown_option, token};
+    }
+    int taken = 1;
+    if (value == nullptr) {
+      if (i + 1 == argc) {
+        optind = i + 1;
+        return {Error::missing_value, token};
+      }
+      value = argv[i + 1];
+      taken = 2;
+    }
+    std::rotate(argv + first, argv + i, argv + i + taken);
+    first += taken;
+    i += taken;
+    const field &f = schema.fields[index];
+    if (!f.assign(object + f.offset, value)) {
+      // the last token taken, as getopt_long reports it
+      optind = i;
+      return {Error::bad_value, argv[first - 1]};
+    }
+  }
+  optind = first;
+  return {Error::none, {}};
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::add_required(std::initializer_list<string_ref> names) {
+  add_constraint_(constraint_kind::required, nullptr, names);
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::add_exclusive(std::initializer_list<string_ref> names) {
+  add_constraint_(constraint_kind::exclusive, nullptr, names);
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::add_implies(string_ref name, std::initializer_list<string_ref> implied) {
+  add_constraint_(constraint_kind::implies, &name, implied);
+}
+
+TINY_CMDLINE_INLINE int32_t TinyCmdline::slot_of_(string_ref name) const {
+  int32_t key = -1;
+  if (name.size() > 2 && name[0] == '-' && name[1] == '-') {
+    key = long_names_.find(name.data() + 2, name.size() - 2).key;
+  } else if (name.size() == 2 && name[0] == '-') {
+    key = static_cast<unsigned char>(name[1]);
+  }
+  const auto it = operators_.find(key);
+  return (it == operators_.end()) ? -1 : static_cast<int32_t>(it->second.slot);
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::add_constraint_(constraint_kind kind, const string_ref *trigger,
+                                                      std::initializer_list<string_ref> names) {
+  constraint added{kind, -1, vector_t<uint64_t>(set_bits_.size(), 0, resource_), vector_t<uint32_t>(resource_),
+                   vector_t<string_t>(resource_)};
+  if (trigger != nullptr) {
+    added.trigger = slot_of_(*trigger);
+    if (added.trigger < 0) {
+      fprintf(stderr, "unknown option %.*s in a constraint\n", static_cast<int>(trigger->size()), trigger->data());
+      return;
+    }
+  }
+  for (const auto &name : names) {
+    const int32_t slot = slot_of_(name);
+    if (slot < 0) {
+      fprintf(stderr, "unknown option %.*s in a constraint\n", static_cast<int>(name.size()), name.data());
+      return;
+    }
+    added.mask[static_cast<uint32_t>(slot) >> 6] |= uint64_t{1} << (slot & 63);
+    added.slots.push_back(static_cast<uint32_t>(slot));
+    added.names.emplace_back(name.data(), name.size(), resource_);
+  }
+  if (trigger != nullptr) {
+    added.names.emplace_back(trigger->data(), trigger->size(), resource_);
+  }
+  constraints_.push_back(std::move(added));
+  constraint_check_ = &TinyCmdline::check_constraints_;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::check_constraints_(std::string &violations) const {
+  for (const auto &c : constraints_) {
+    bool violated = false;
+    if (c.kind == constraint_kind::exclusive) {
+      bool seen = false;
+      for (size_t i = 0; i < c.mask.size() && !violated; ++i) {
+        const uint64_t given = c.mask[i] & scan_bits_[i];
+        violated = (given & (given - 1)) != 0 || (seen && given != 0);
+        seen = seen || given != 0;
+      }
+    } else if (c.kind == constraint_kind::required || scanned_(static_cast<uint32_t>(c.trigger))) {
+      for (size_t i = 0; i < c.mask.size() && !violated; ++i) {
+        violated = (c.mask[i] & ~scan_bits_[i]) != 0;
+      }
+    }
+    if (!violated) {
+      continue;
+    }
+    // the cold path names the options involved
+    std::string given;
+    for (size_t i = 0; i < c.slots.size(); ++i) {
+      const bool is_set = scanned_(c.slots[i]);
+      const std::string name(c.names[i].c_str());
+      if (c.kind == constraint_kind::required && !is_set) {
+        violations += name + " is required\n";
+      } else if (c.kind == constraint_kind::implies && !is_set) {
+        violations += std::string(c.names.back().c_str()) + " requires " + name + "\n";
+      } else if (c.kind == constraint_kind::exclusive && is_set) {
+        given += (given.empty() ? "" : ", ") + name;
+      }
+    }
+    if (c.kind == constraint_kind::exclusive) {
+      violations += given + " are mutually exclusive\n";
+    }
+  }
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::exit_on_error_(const parse_result &result) {
+  if (!result) {
+    const char *argument = result.argument.c_str();
+    switch (result.error) {
+      case Error::help:
+        break;
+      case Error::unknown_option:
+        fprintf(stderr, "unknown option %s\n", argument);
+        break;
+      case Error::missing_value:
+        fprintf(stderr, "missing value for %s\n", argument);
+        break;
+      case Error::unexpected_value:
+        fprintf(stderr, "unexpected value in %s\n", argument);
+        break;
+      case Error::bad_value:
+        fprintf(stderr, "bad value %s%s%s\n", argument, result.detail.empty() ? "" : " for ", result.detail.c_str());
+        break;
+      case Error::too_long:
+        fprintf(stderr, "argument too long: %s\n", argument);
+        break;
+      case Error::not_overridable:
+        fprintf(stderr, "%s cannot be overridden\n", argument);
+        break;
+      case Error::positional:
+        fprintf(stderr, "unexpected argument %s\n", argument);
+        break;
+      default:  // the constraints and the io errors say what failed
+        fprintf(stderr, "%s\n", argument);
+        break;
+    }
+    print_help();
+    exit(result.error == Error::help ? 0 : 1);
+  }
+}
+
+TINY_CMDLINE_INLINE int32_t TinyCmdline::add_option_(operator_option &&option) {
+  // a long name is a key of the trie, a second option with it would replace the first one there
+  const bool long_taken =
+      !option.long_name.empty() && long_names_.find(option.long_name.c_str(), option.long_name.size()).key >= 0;
+  const auto opt_val = static_cast<int32_t>((option.short_name == '\0') ? opt_val_ : option.short_name);
+  if (long_taken || operators_.count(opt_val) != 0) {
+    if (option.short_name == '\0') {
+      fprintf(stderr, "duplicate option --%s\n", option.long_name.c_str());
+    } else if (option.long_name.empty()) {
+      fprintf(stderr, "duplicate option -%c\n", option.short_name);
+    } else {
+      fprintf(stderr, "duplicate option -%c, --%s\n", option.short_name, option.long_name.c_str());
+    }
+    return -1;
+  }
+  if (option.short_name == '\0') {
+    ++opt_val_;
+  }
+  const auto slot = static_cast<uint32_t>(values_.size());
+  option.slot = slot;
+  const auto &added = operators_.emplace(opt_val, std::move(option)).first->second;
+  if (!added.long_name.empty()) {
+    long_names_.insert(added.long_name.c_str(), added.long_name.size(), opt_val, false);
+  }
+  if (added.bulk) {
+    bulk_keys_.push_back(opt_val);
+  }
+  values_.push_back(nullptr);
+  handle_types_.push_back(nullptr);
+  set_bits_.resize((values_.size() + 63) / 64);
+  scan_bits_.resize(set_bits_.size());
+  ++schema_version_;
+  return static_cast<int32_t>(slot);
+}
+
+TINY_CMDLINE_INLINE bool TinyCmdline::stream_value_(const stream_operator_t &f, const char *optarg) {
+  if (optarg != nullptr && (strcmp(optarg, "-") == 0 || optarg[0] == '@')) {
+    const bool is_stdin = (optarg[0] == '-');
+    const int fd = is_stdin ? STDIN_FILENO : open(optarg + 1, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    const bool complete = read_chunks_(fd, [&f](const char *chunk, size_t size) {
+      f(chunk, size);
+      return true;
+    });
+    if (!is_stdin) {
+      const int read_errno = errno;
+      close(fd);
+      errno = read_errno;
+    }
+    if (!complete) {
+      return false;
+    }
+  } else if (optarg != nullptr) {
+    f(optarg, strlen(optarg));
+  }
+  f(nullptr, 0);
+  return true;
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::Error TinyCmdline::dispatch_local_(int32_t key, const char *value,
+                                                                    const char *(*keep)(TinyCmdline &, const char *)) {
+  auto &option = operators_.at(key);
+  // a rejected value leaves the option unset, as it leaves its value untouched
+  if (option.assign != nullptr && !option.assign(option.target, value)) {
+    return Error::bad_value;
+  }
+  set_bits_[option.slot >> 6] |= uint64_t{1} << (option.slot & 63);
+  scan_bits_[option.slot >> 6] |= uint64_t{1} << (option.slot & 63);
+  if (option.assign != nullptr) {
+    return Error::none;
+  }
+  if (option.stream) {
+    if (!stream_value_(option.stream, value)) {
+      return Error::io;
+    }
+  } else if (!option.bulk) {
+    option.op(value);
+  } else if (keep != nullptr && value != nullptr) {
+    option.values.push_back(keep(*this, value));
+  } else {
+    option.values.push_back(value);
+  }
+  return Error::none;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::flush_bulk_(bool call) {
+  for (const auto key : bulk_keys_) {
+    auto &option = operators_.at(key);
+    if (call && !option.values.empty()) {
+      option.bulk(option.values.data(), option.values.size());
+    }
+    option.values.clear();
+  }
+  bulk_strings_.clear();
+  if (parent_ != nullptr) {
+    parent_->flush_bulk_(call);
+  }
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::option_ref TinyCmdline::find_key_(int32_t key) {
+  if (operators_.count(key) != 0) {
+    return {this, key};
+  }
+  return (parent_ != nullptr) ? parent_->find_key_(key) : option_ref{nullptr, -1};
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::long_match TinyCmdline::find_long_(const char *name, size_t len) {
+  const auto found = long_names_.find(name, len);
+  long_match result{{nullptr, -1}, {nullptr, -1}};
+  if (found.key >= 0) {
+    result.option = {this, found.key};
+  }
+  if (found.prefix >= 0) {
+    result.prefix = {this, found.prefix};
+  }
+  if (parent_ != nullptr && (result.option.owner == nullptr || result.prefix.owner == nullptr)) {
+    const auto inherited = parent_->find_long_(name, len);
+    // the parent option may be hidden by an option of this parser with the same key
+    if (result.option.owner == nullptr && inherited.option.owner != nullptr &&
+        operators_.count(inherited.option.key) == 0) {
+      result.option = inherited.option;
+    }
+    if (result.prefix.owner == nullptr) {
+      result.prefix = inherited.prefix;
+    }
+  }
+  return result;
+}
+
+TINY_CMDLINE_INLINE bool TinyCmdline::hides_(int32_t key, const operator_option &option) const {
+  if (operators_.count(key) != 0) {
+    return true;
+  }
+  return !option.long_name.empty() && long_names_.find(option.long_name.c_str(), option.long_name.size()).key >= 0;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::for_each_option_(
+    const callable<void(int32_t, const operator_option &)> &f) const {
+  for (const auto &option_it : operators_) {
+    f(option_it.first, option_it.second);
+  }
+  if (parent_ != nullptr) {
+    parent_->for_each_option_([this, &f](int32_t key, const operator_option &option) {
+      if (!hides_(key, option)) {
+        f(key, option);
+      }
+    });
+  }
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::scan_dispatch_(scan_state &state, const option_ref &ref, const char *value,
+                                                     const char *token) {
+  const argv_dispatch dispatch{ref, false, value, nullptr, 0};
+  if (state.divert != nullptr) {
+    const Error error = state.divert(state, dispatch);
+    if (error != Error::none && state.result) {
+      state.result = dispatch_failure_(error, ref, value, token);
+    }
+    return;
+  }
+  if (state.record != nullptr) {
+    state.record(state, dispatch);
+  }
+  const Error error = dispatch_(ref, value, state.keep);
+  if (error != Error::none && state.result) {
+    state.result = dispatch_failure_(error, ref, value, (error == Error::io) ? io_failure_(value) : std::string(token));
+  }
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::parse_result TinyCmdline::dispatch_failure_(Error error, const option_ref &ref,
+                                                                             const char *value, std::string argument) {
+  if (error != Error::bad_value) {
+    return {error, std::move(argument)};
+  }
+  const auto &option = option_of_(ref);
+  std::string detail = option.long_name.empty() ? std::string("-") + option.short_name
+                                                : std::string("--") + option.long_name.c_str();
+  std::string why;
+  if (option.explain != nullptr && value != nullptr) {
+    option.explain(option.target, value, why);
+  }
+  return {error, std::move(argument), why.empty() ? detail : detail + ": " + why};
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::scan_dispatch_prefix_(scan_state &state, const option_ref &prefix,
+                                                            string_ref name, const char *value) {
+  const argv_dispatch dispatch{prefix, true, value, name.data(), name.size()};
+  if (state.divert != nullptr) {
+    const Error error = state.divert(state, dispatch);
+    if (error != Error::none) {
+      scan_fail_(state, error, "--" + name.str());
+    }
+    return;
+  }
+  if (state.record != nullptr) {
+    state.record(state, dispatch);
+  }
+  dispatch_prefix_(prefix, name, value);
+}
+
+TINY_CMDLINE_INLINE TinyCmdline::Error TinyCmdline::take_preset_(scan_state &state, const argv_dispatch &dispatch) {
+  memory_resource *resource = state.preset->get_allocator().resource();
+  state.preset->push_back(preset_value{dispatch.ref, dispatch.is_prefix, dispatch.value != nullptr,
+                                       string_t(dispatch.name ? dispatch.name : "", dispatch.name_size, resource),
+                                       string_t(dispatch.value ? dispatch.value : "", resource)});
+  return Error::none;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::record_dispatch_(scan_state &state, const argv_dispatch &dispatch) {
+  state.recorded->push_back(dispatch);
+}
+
+TINY_CMDLINE_INLINE bool TinyCmdline::apply_preset_(void *target, const char *value) {
+  const auto &preset_opt = *static_cast<const preset_option *>(target);
+  for (const auto &preset : preset_opt.presets) {
+    if (value == nullptr || preset.first != value) {
+      continue;
+    }
+    bool ok = true;
+    for (const auto &argument : preset.second) {
+      const char *argument_value = argument.has_value ? argument.value.c_str() : nullptr;
+      if (argument.is_prefix) {
+        dispatch_prefix_(argument.ref, string_ref(argument.name.c_str(), argument.name.size()), argument_value);
+      } else {
+        ok = dispatch_(argument.ref, argument_value) == Error::none && ok;
+      }
+    }
+    return ok;
+  }
+  return false;
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::scan_token_(scan_state &state, const char *token, size_t size) {
+  if (!state.result) {
+    return;
+  }
+  if (state.pending.owner != nullptr) {
+    const option_ref pending = state.pending;
+    state.pending = {nullptr, -1};
+    scan_dispatch_(state, pending, token, token);
+    return;
+  }
+  if (state.pending_prefix.owner != nullptr) {
+    const option_ref prefix = state.pending_prefix;
+    state.pending_prefix = {nullptr, -1};
+    scan_dispatch_prefix_(state, prefix, state.pending_name(), token);
+    return;
+  }
+  // the class of the token follows from its first bytes and its size, only a long option is searched for a value
+  if (state.terminated || size < 2 || token[0] != '-') {
+    scan_positional_(state, token);
+    return;
+  }
+  if (token[1] == '-') {
+    if (size == 2) {
+      state.terminated = true;
+      return;
+    }
+    const char *name = token + 2;
+    const char *eq = static_cast<const char *>(memchr(name, '=', size - 2));
+    const size_t name_len = (eq == nullptr) ? size - 2 : static_cast<size_t>(eq - name);
+    if (name_len == 4 && memcmp(name, "help", 4) == 0) {
+      scan_fail_(state, Error::help, token);
+      return;
+    }
+    auto found = find_long_(name, name_len);
+    if (found.option.owner == nullptr && state.from_argv) {
+      // as with getopt_long, an abbreviated option comes before a prefix handler
+      found.option = abbreviated_(name, name_len);
+    }
+    if (found.option.owner == nullptr && found.prefix.owner == nullptr) {
+      scan_fail_(state, Error::unknown_option, token);
+      return;
+    }
+    const bool is_prefix = (found.option.owner == nullptr);
+    const Argument type = is_prefix ? prefix_of_(found.prefix).type : option_of_(found.option).type;
+    if (eq != nullptr && type == Argument::none) {
+      scan_fail_(state, Error::unexpected_value, token);
+      return;
+    }
+    if (is_prefix && (eq != nullptr || type != Argument::required)) {
+      scan_dispatch_prefix_(state, found.prefix, string_ref(name, name_len), (eq != nullptr) ? eq + 1 : nullptr);
+    } else if (is_prefix) {
+      // the name waits for the value in the next token, the streaming parsers reuse the storage of this one
+      if (!state.from_argv && name_len >= sizeof(state.prefix_copy)) {
+        scan_fail_(state, Error::too_long, token);
+        return;
+      }
+      state.prefix_name = state.from_argv ? name : nullptr;
+      state.prefix_size = name_len;
+      if (!state.from_argv) {
+        memcpy(state.prefix_copy, name, name_len);
+      }
+      state.pending_prefix = found.prefix;
+    } else if (eq != nullptr) {
+      scan_dispatch_(state, found.option, eq + 1, token);
+    } else if (type == Argument::required) {
+      state.pending = found.option;
+    } else {
+      scan_dispatch_(state, found.option, nullptr, token);
+    }
+    return;
+  }
+  for (const char *p = token + 1; *p != '\0' && state.result; ++p) {
+    const option_ref ref = find_key_(static_cast<int32_t>(*p));
+    // as with getopt_long, an unregistered 'h' only asks for help on its own in argv, -vh is an unknown option
+    const bool help = *p == 'h' && (!state.from_argv || ref.owner != nullptr || size == 2);
+    if (help || ref.owner == nullptr) {
+      scan_fail_(state, help ? Error::help : Error::unknown_option, std::string("-") + *p);
+      return;
+    }
+    const Argument type = option_of_(ref).type;
+    if (type == Argument::none) {
+      scan_dispatch_(state, ref, nullptr, token);
+      continue;
+    }
+    // the rest of the token is the value, or the next token is for a required value, or an optional one in argv
+    if (p[1] != '\0') {
+      scan_dispatch_(state, ref, p + 1, token);
+    } else if (type == Argument::required || state.from_argv) {
+      state.pending = ref;
+    } else {
+      scan_dispatch_(state, ref, nullptr, token);
+    }
+    return;
+  }
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::scan_positional_(scan_state &state, const char *token) {
+  if (state.from_argv) {
+    return;
+  }
+  if (state.preset != nullptr || state.overlay != nullptr) {
+    scan_fail_(state, (state.overlay != nullptr) ? Error::not_overridable : Error::positional, token);
+    return;
+  }
+  for (TinyCmdline *cmd = this; cmd != nullptr; cmd = cmd->parent_) {
+    if (cmd->positional_) {
+      cmd->positional_(token);
+      return;
+    }
+  }
+  scan_fail_(state, Error::positional, token);
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::scan_finish_(scan_state &state) {
+  if (state.pending.owner != nullptr) {
+    const auto &option = option_of_(state.pending);
+    scan_fail_(state, Error::missing_value,
+               option.long_name.empty() ? std::string("-") + option.short_name
+                                        : std::string("--") + option.long_name.c_str());
+  } else if (state.pending_prefix.owner != nullptr) {
+    scan_fail_(state, Error::missing_value, "--" + state.pending_name().str());
+  }
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::usage_() {
+  // options under a namespace are grouped after the others, sorted by namespace then name, a prefix handler first
+  struct entry {
+    string_ref name_space;
+    string_ref name;                // empty for a prefix handler
+    const operator_option *option;  // nullptr for a prefix handler
+    const prefix_option *prefix;
+  };
+  vector_t<entry> grouped(resource_);
+  for_each_option_([&grouped](int32_t, const operator_option &option) {
+    const char *dot = strrchr(option.long_name.c_str(), '.');
+    if (dot != nullptr) {
+      const string_ref name(option.long_name.c_str(), option.long_name.size());
+      grouped.push_back(entry{string_ref(name.data(), static_cast<size_t>(dot - name.data())), name, &option, nullptr});
+      return;
+    }
+    print_option_(option.short_name, option.long_name.c_str(), option.type, option.help.c_str());
+  });
+  for (const TinyCmdline *cmd = this; cmd != nullptr; cmd = cmd->parent_) {
+    for (const auto &prefix : cmd->prefixes_) {
+      const string_ref name_space(prefix.prefix.c_str(), prefix.prefix.size());
+      bool hidden = false;
+      for (const auto &other : grouped) {
+        hidden = hidden || (other.prefix != nullptr && other.name_space == name_space);
+      }
+      if (!hidden) {
+        grouped.push_back(entry{name_space, string_ref(), nullptr, &prefix});
+      }
+    }
+  }
+  // an insertion sort, the help is printed once and has few namespaced options
+  for (size_t i = 1; i < grouped.size(); ++i) {
+    for (size_t j = i; j > 0; --j) {
+      const entry &a = grouped[j - 1];
+      const entry &b = grouped[j];
+      if (!((a.name_space != b.name_space) ? b.name_space < a.name_space : b.name < a.name)) {
+        break;
+      }
+      std::swap(grouped[j - 1], grouped[j]);
+    }
+  }
+  string_ref current_namespace;
+  for (const auto &item : grouped) {
+    if (item.name_space != current_namespace) {
+      current_namespace = item.name_space;
+      fprintf(stdout, "%.*s:\n", static_cast<int>(current_namespace.size()), current_namespace.data());
+    }
+    if (item.option != nullptr) {
+      print_option_(item.option->short_name, item.option->long_name.c_str(), item.option->type,
+                    item.option->help.c_str());
+    } else {
+      string_t name(item.prefix->prefix);
+      name += ".*";
+      print_option_('\0', name.c_str(), item.prefix->type, item.prefix->help.c_str());
+    }
+  }
+}
+
+TINY_CMDLINE_INLINE void TinyCmdline::print_option_(char short_name, const char *long_name, Argument type,
+                                                    const char *help) {
+  const char *arg_str = (type == Argument::required) ? " <arg> " : " ";
+  if (short_name == '\0') {
+    fprintf(stdout, "\t--%s%s%s\n", long_name, arg_str, help);
+  } else if (long_name[0] == '\0') {
+    fprintf(stdout, "\t-%c%s%s\n", short_name, arg_str, help);
+  } else {
+    fprintf(stdout, "\t-%c, --%s%s%s\n", short_name, long_name, arg_str, help);
+  }
+}
+
+}  // namespace TINY_CMDLINE_MODE
+}  // namespace tiny_cmdline
+
+#endif
 
 #endif  // TINY_CMDLINE_H
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Measures the time to compile 1, 10 and 100 translation units using the parser, header-only and with
+# TINY_CMDLINE_COMPILED_LIB, where tiny_cmdline.cpp is compiled once and counted in the total.
+#
+# $ tools/compile_time.sh [compiler flags, default -std=c++11 -O2]
+
+set -e
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+flags=${1:--std=c++11 -O2}
+cxx=${CXX:-g++}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# every unit registers a few options, like a module adding its own flags
+for i in $(seq 1 100); do
+  cat > "$work/unit$i.cpp" <<EOF
+#include "tiny_cmdline.h"
+
+void register_unit$i(tiny_cmdline::TinyCmdline &cmd) {
+  static int32_t count = 0;
+  static uint16_t port = 0;
+  cmd.add_argument("count$i", '\0', count, "A count.");
+  cmd.add_argument("port$i", '\0', port, "A port.");
+  cmd.add_argument("verbose$i", '\0', []() {}, tiny_cmdline::TinyCmdline::Argument::none, "More output.");
+  auto limit = cmd.add_argument<int64_t>("limit$i", '\0', "A limit.");
+  (void)limit;
+}
+EOF
+done
+
+now_ms() {
+  echo $(($(date +%s%N) / 1000000))
+}
+
+# compile_units <count> <extra flags>
+compile_units() {
+  for i in $(seq 1 "$1"); do
+    # shellcheck disable=SC2086
+    $cxx $flags $2 -I"$root" -c "$work/unit$i.cpp" -o "$work/unit$i.o"
+  done
+}
+
+printf "%-6s %12s %12s\n" "units" "header-only" "compiled-lib"
+for count in 1 10 100; do
+  start=$(now_ms)
+  compile_units "$count" ""
+  header_only=$(($(now_ms) - start))
+
+  start=$(now_ms)
+  # shellcheck disable=SC2086
+  $cxx $flags -I"$root" -c "$root/tiny_cmdline.cpp" -o "$work/tiny_cmdline.o"
+  compile_units "$count" "-DTINY_CMDLINE_COMPILED_LIB"
+  compiled_lib=$(($(now_ms) - start))
+
+  printf "%-6s %10sms %10sms\n" "$count" "$header_only" "$compiled_lib"
+done
@@ -0,0 +1,28 @@
+#!/bin/sh
+# Compares the code size of the working tree example.cpp and header against example.cpp and the header of a revision.
+#
+# $ tools/size_report.sh [revision, default HEAD] [compiler flags, default -std=c++11 -Os]
+
+set -e
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+revision=${1:-HEAD}
+flags=${2:--std=c++11 -Os}
+cxx=${CXX:-g++}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+mkdir "$work/base"
+git -C "$root" show "$revision:tiny_cmdline.h" > "$work/base/tiny_cmdline.h"
+# the example of the revision, the current one may use options its header does not have
+git -C "$root" show "$revision:example.cpp" > "$work/base/example.cpp"
+
+# shellcheck disable=SC2086
+$cxx $flags -I"$root" -o "$work/current" "$root/example.cpp"
+# shellcheck disable=SC2086
+$cxx $flags -I"$work/base" -o "$work/base/example" "$work/base/example.cpp"
+
+echo "$revision:"
+size "$work/base/example"
+echo "working tree:"
+size "$work/current"
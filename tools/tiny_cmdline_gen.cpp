@@ -0,0 +1,260 @@
+/*
+  MIT License
+*/
+
+// Generates the static option tables of a schema, to be parsed with TinyCmdline::parse(schema, object, argc, argv)
+// without any runtime registration.
+//
+// $ g++ -std=c++11 -o tiny_cmdline_gen tools/tiny_cmdline_gen.cpp
+// $ ./tiny_cmdline_gen tools/example.schema parsed_args_schema.h
+//
+// The schema is a text file, one declaration per line, '#' starts a comment:
+//   struct ParsedArgs
+//   <member> <type> <long name or -> <short name or -> <help text>
+
+#include "../tiny_cmdline.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct schema_field {
+  std::string member;
+  std::string type;
+  std::string long_name;
+  char short_name;
+  std::string help;
+};
+
+struct schema {
+  std::string name;
+  std::vector<schema_field> fields;
+};
+
+[[noreturn]] void fail(const std::string &path, int32_t line, const std::string &message) {
+  fprintf(stderr, "%s:%d: %s\n", path.c_str(), line, message.c_str());
+  exit(1);
+}
+
+schema load_schema(const std::string &path) {
+  std::ifstream in(path);
+  if (!in) {
+    perror(path.c_str());
+    exit(1);
+  }
+  schema result;
+  std::string line;
+  int32_t line_no = 0;
+  while (std::getline(in, line)) {
+    ++line_no;
+    const auto comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    std::istringstream tokens(line);
+    std::string first;
+    if (!(tokens >> first)) {
+      continue;
+    }
+    if (first == "struct") {
+      if (!(tokens >> result.name)) {
+        fail(path, line_no, "missing struct name");
+      }
+      continue;
+    }
+    schema_field field;
+    std::string short_name;
+    field.member = first;
+    if (!(tokens >> field.type >> field.long_name >> short_name)) {
+      fail(path, line_no, "expected <member> <type> <long name> <short name> <help>");
+    }
+    std::getline(tokens >> std::ws, field.help);
+    if (field.long_name == "-") {
+      field.long_name.clear();
+    }
+    field.short_name = (short_name == "-") ? '\0' : short_name[0];
+    if (short_name.size() != 1 || (field.short_name != '\0' && !isalnum(static_cast<unsigned char>(short_name[0])))) {
+      fail(path, line_no, "the short name must be one alphanumeric character or -");
+    }
+    if (field.long_name.empty() && field.short_name == '\0') {
+      fail(path, line_no, "the option needs a long or a short name");
+    }
+    if (field.short_name == 'h' || field.long_name == "help") {
+      fail(path, line_no, "-h and --help are reserved for help");
+    }
+    for (const auto &other : result.fields) {
+      if ((field.short_name != '\0' && other.short_name == field.short_name) ||
+          (!field.long_name.empty() && other.long_name == field.long_name)) {
+        fail(path, line_no, "duplicate option " + field.member);
+      }
+    }
+    result.fields.push_back(field);
+  }
+  if (result.name.empty()) {
+    fail(path, line_no, "missing struct declaration");
+  }
+  return result;
+}
+
+std::string escape(const std::string &text) {
+  std::string result;
+  for (const char ch : text) {
+    switch (ch) {
+      case '\\': result += "\\\\"; break;
+      case '"': result += "\\\""; break;
+      case '\n': result += "\\n"; break;
+      case '\t': result += "\\t"; break;
+      default: result += ch; break;
+    }
+  }
+  return result;
+}
+
+std::string snake_case(const std::string &name) {
+  std::string result;
+  for (size_t i = 0; i < name.size(); ++i) {
+    const auto ch = static_cast<unsigned char>(name[i]);
+    if (isupper(ch) && i > 0) {
+      result += '_';
+    }
+    result += static_cast<char>(tolower(ch));
+  }
+  return result;
+}
+
+// the same text as TinyCmdline::usage_()
+std::string usage(const schema &s) {
+  std::string result;
+  for (const auto &field : s.fields) {
+    result += "\t";
+    if (field.short_name != '\0') {
+      result += std::string("-") + field.short_name + (field.long_name.empty() ? "" : ", ");
+    }
+    if (!field.long_name.empty()) {
+      result += "--" + field.long_name;
+    }
+    result += " <arg> " + field.help + "\n";
+  }
+  return result;
+}
+
+// searches a seed making TinyCmdline::hash_name collision-free over the long names
+std::vector<int32_t> perfect_hash(const schema &s, uint32_t &mask, uint32_t &seed) {
+  size_t size = 2;
+  while (size < s.fields.size() * 2) {
+    size *= 2;
+  }
+  for (;; size *= 2) {
+    mask = static_cast<uint32_t>(size - 1);
+    for (seed = 0; seed < 1u << 16; ++seed) {
+      std::vector<int32_t> table(size, -1);
+      bool perfect = true;
+      for (size_t i = 0; i < s.fields.size() && perfect; ++i) {
+        const auto &name = s.fields[i].long_name;
+        if (name.empty()) {
+          continue;
+        }
+        auto &bucket = table[tiny_cmdline::TinyCmdline::hash_name(name.c_str(), name.size(), seed) & mask];
+        perfect = (bucket < 0);
+        bucket = static_cast<int32_t>(i);
+      }
+      if (perfect) {
+        return table;
+      }
+    }
+  }
+}
+
+std::string header_guard(const std::string &path) {
+  std::string guard;
+  for (const char ch : path.substr(path.find_last_of('/') + 1)) {
+    guard += isalnum(static_cast<unsigned char>(ch)) ? static_cast<char>(toupper(static_cast<unsigned char>(ch))) : '_';
+  }
+  return guard;
+}
+
+void generate(const schema &s, const std::string &schema_path, FILE *out, const std::string &guard) {
+  const std::string ns = snake_case(s.name) + "_schema";
+  uint32_t mask = 0;
+  uint32_t seed = 0;
+  const auto hash = perfect_hash(s, mask, seed);
+
+  fprintf(out, "// generated by tiny_cmdline_gen from %s, do not edit\n", schema_path.c_str());
+  fprintf(out, "// convert<T> specializations of the field types must be visible before this header\n\n");
+  fprintf(out, "#ifndef %s\n#define %s\n\n", guard.c_str(), guard.c_str());
+  fprintf(out, "#include <cstdint>\n#include <string>\n\n#include \"tiny_cmdline.h\"\n\n");
+
+  fprintf(out, "struct %s {\n", s.name.c_str());
+  for (const auto &field : s.fields) {
+    fprintf(out, "  %s %s;\n", field.type.c_str(), field.member.c_str());
+  }
+  fprintf(out, "};\n\nnamespace %s {\n\n", ns.c_str());
+
+  // for TinyCmdline::literal_known(), a static_assert on the default command lines of the schema
+  std::string long_names;
+  for (const auto &field : s.fields) {
+    if (!field.long_name.empty()) {
+      long_names += "\"" + field.long_name + "\", ";
+    }
+  }
+  if (!long_names.empty()) {
+    long_names.erase(long_names.size() - 2);
+    fprintf(out, "constexpr const char *const long_names[] = {%s};\n\n", long_names.c_str());
+  }
+
+  fprintf(out, "static const tiny_cmdline::TinyCmdline::field fields[] = {\n");
+  for (const auto &field : s.fields) {
+    const std::string short_name = (field.short_name == '\0') ? "0" : std::string("'") + field.short_name + "'";
+    fprintf(out, "    TINY_CMDLINE_FIELD(%s, %s, \"%s\", %s, \"%s\"),\n", s.name.c_str(), field.member.c_str(),
+            field.long_name.c_str(), short_name.c_str(), escape(field.help).c_str());
+  }
+  fprintf(out, "};\n\n");
+
+  std::vector<int32_t> short_fields(256, -1);
+  for (size_t i = 0; i < s.fields.size(); ++i) {
+    if (s.fields[i].short_name != '\0') {
+      short_fields[static_cast<unsigned char>(s.fields[i].short_name)] = static_cast<int32_t>(i);
+    }
+  }
+  fprintf(out, "static const int32_t short_fields[256] = {");
+  for (size_t i = 0; i < short_fields.size(); ++i) {
+    fprintf(out, "%s%d,", (i % 16 == 0) ? "\n    " : " ", short_fields[i]);
+  }
+  fprintf(out, "\n};\n\n");
+
+  fprintf(out, "static const int32_t long_hash[%zu] = {", hash.size());
+  for (size_t i = 0; i < hash.size(); ++i) {
+    fprintf(out, "%s%d,", (i % 16 == 0) ? "\n    " : " ", hash[i]);
+  }
+  fprintf(out, "\n};\n\n");
+
+  fprintf(out, "static const char help[] = \"%s\";\n\n", escape(usage(s)).c_str());
+
+  fprintf(out, "static const tiny_cmdline::TinyCmdline::static_schema schema = {\n");
+  fprintf(out, "    fields, %zu, short_fields, long_hash, %uu, %uu, help,\n",
+          s.fields.size(), mask, seed);
+  fprintf(out, "};\n\n}  // namespace %s\n\n#endif  // %s\n", ns.c_str(), guard.c_str());
+}
+
+}  // namespace
+
+int32_t main(int32_t argc, char *argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <schema> <output header>\n", argv[0]);
+    return 1;
+  }
+  const schema s = load_schema(argv[1]);
+  FILE *out = fopen(argv[2], "w");
+  if (out == nullptr) {
+    perror(argv[2]);
+    return 1;
+  }
+  generate(s, argv[1], out, header_guard(argv[2]));
+  return fclose(out) == 0 ? 0 : 1;
+}